@@ -0,0 +1,105 @@
+#------------------------------------------------------------------------
+# Benchmark of Morton-ordered mesh output (--morton)
+#
+# Exports a scene (default: scenes/c4d/mesh_test.c4d) with and without
+# --morton, renders both with POV-Ray and compares export time, file size,
+# compressed size and POV-Ray parse/render times.
+#
+# Usage: python mesh_order.py [scene.c4d] [runs]
+#
+# CINEMA2POV and POVRAY environment variables override the executables.
+#------------------------------------------------------------------------
+import os
+import re
+import sys
+import time
+import zlib
+import subprocess
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+root_dir = os.path.dirname(base_dir)
+
+converter_path = os.environ.get("CINEMA2POV", os.path.join(root_dir, "cinema2pov.exe"))
+if os.name == "nt":
+  pov_path = os.environ.get("POVRAY", "C:/Program Files/POV-Ray/v3.8-beta/bin/pvengine64.exe")
+else:
+  pov_path = os.environ.get("POVRAY", "povray")
+
+work_dir = os.path.join(base_dir, "out")
+
+scene_template = """#version 3.7;
+global_settings { assumed_gamma 1 }
+%s
+camera { perspective location <-8, 8, 8> * 2 look_at <0, 0, 0> angle 45 }
+light_source { <-10, 20, 10> rgb 1 }
+background { rgb 0.2 }
+#include "%s"
+"""
+
+def materials(inc_file):
+  with open(inc_file) as f:
+    names = sorted(set(re.findall(r"material \{ (\w+) \}", f.read())))
+  return "\n".join("#declare %s = material { texture { pigment { rgb 0.8 } } }" % n for n in names)
+
+def pov_times(log):
+  times = {}
+  for name in ("Parse", "Render"):
+    m = re.search(name + r" Time:.*\(\s*([\d.]+) seconds\)", log)
+    if m:
+      times[name] = float(m.group(1))
+  return times
+
+def run(scene, options, tag):
+  inc_file = os.path.join(work_dir, "mesh_%s.inc" % tag)
+  pov_file = os.path.join(work_dir, "mesh_%s.pov" % tag)
+
+  start = time.perf_counter()
+  if subprocess.call([converter_path] + options + [scene, inc_file], stdout=subprocess.DEVNULL) != 0:
+    return None
+  export_time = time.perf_counter() - start
+
+  with open(pov_file, "w") as f:
+    f.write(scene_template % (materials(inc_file), os.path.basename(inc_file)))
+
+  start = time.perf_counter()
+  if os.name == "nt":
+    cmd = [pov_path, "/EXIT", "/RENDER", pov_file, "+W640", "+H480", "-D"]
+  else:
+    cmd = [pov_path, pov_file, "+W640", "+H480", "-D", "-V", "+L" + work_dir]
+  res = subprocess.run(cmd, cwd=work_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+  pov_time = time.perf_counter() - start
+
+  with open(inc_file, "rb") as f:
+    data = f.read()
+
+  result = { "Export": export_time, "POV-Ray": pov_time, "Size": len(data), "Compressed": len(zlib.compress(data, 9)) }
+  result.update(pov_times(res.stdout))
+  return result
+
+def main():
+  scene = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root_dir, "scenes", "c4d", "mesh_test.c4d")
+  runs = int(sys.argv[2]) if len(sys.argv) > 2 else 3
+  os.makedirs(work_dir, exist_ok=True)
+
+  # Best of runs
+  results = {}
+  for tag, options in (("original", []), ("morton", ["--morton"])):
+    for i in range(runs):
+      r = run(scene, options, tag)
+      if not r:
+        print("%s: export failed" % tag)
+        sys.exit(1)
+      best = results.setdefault(tag, r)
+      for key in r:
+        best[key] = min(best[key], r[key])
+
+  print("\n%-12s %14s %14s %8s" % ("", "original", "morton", "ratio"))
+  for key in ("Export", "Parse", "Render", "POV-Ray", "Size", "Compressed"):
+    if key not in results["original"] or key not in results["morton"]:
+      continue
+    a = results["original"][key]
+    b = results["morton"][key]
+    print("%-12s %14.3f %14.3f %8.3f" % (key, a, b, b / a if a else 0.0))
+
+if __name__=='__main__':
+  main()
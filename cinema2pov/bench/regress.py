@@ -0,0 +1,162 @@
+#------------------------------------------------------------------------
+# Golden-corpus regression and performance suite
+#
+# Converts every scene of scenes/c4d, compares the output with the golden
+# file scenes/golden/<scene>.inc and appends export time and output size
+# per scene to history.jsonl (one JSON object per line). A scene fails if
+# it has no golden file, its output differs from the golden file, the
+# export fails, or it is slower than the median of its recent passing runs
+# by more than the threshold. Golden files are written with --update from
+# a known-good build and committed.
+#
+# Usage: python regress.py [options] [scene ...]
+#   --update          write the current outputs as golden files
+#   --runs <n>        exports per scene, the fastest counts (default: 3)
+#   --threshold <%>   allowed slowdown (default: 25)
+#   --window <n>      passing runs forming the time baseline (default: 5)
+#   --no-history      don't record this run
+#
+# CINEMA2POV environment variable overrides the executable.
+#------------------------------------------------------------------------
+import os
+import sys
+import glob
+import json
+import time
+import difflib
+import statistics
+import subprocess
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+root_dir = os.path.dirname(base_dir)
+
+converter_path = os.environ.get("CINEMA2POV", os.path.join(root_dir, "cinema2pov.exe"))
+scene_dir = os.path.join(root_dir, "scenes", "c4d")
+golden_dir = os.path.join(root_dir, "scenes", "golden")
+work_dir = os.path.join(base_dir, "out", "regress")
+history_file = os.path.join(base_dir, "history.jsonl")
+
+# Differences of slower runs below this many seconds are noise
+min_slowdown = 0.05
+
+def parse_args(argv):
+  opts = { "update": False, "runs": 3, "threshold": 25.0, "window": 5, "history": True, "scenes": [] }
+  i = 0
+  while i < len(argv):
+    arg = argv[i]
+    if arg == "--update":
+      opts["update"] = True
+    elif arg == "--no-history":
+      opts["history"] = False
+    elif arg in ("--runs", "--threshold", "--window"):
+      i += 1
+      opts[arg[2:]] = float(argv[i]) if arg == "--threshold" else int(argv[i])
+    else:
+      opts["scenes"].append(arg)
+    i += 1
+  return opts
+
+# SDL without the leading comment header, which names the SDK version
+def sdl_lines(fn):
+  with open(fn, errors="replace") as f:
+    lines = f.read().splitlines()
+  i = 0
+  while i < len(lines) and (lines[i].startswith("//") or not lines[i].strip()):
+    i += 1
+  return lines[i:]
+
+def commit_id():
+  try:
+    return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], cwd=root_dir,
+                                   stderr=subprocess.DEVNULL, universal_newlines=True).strip()
+  except (OSError, subprocess.CalledProcessError):
+    return ""
+
+def load_history():
+  history = {}
+  if os.path.exists(history_file):
+    with open(history_file) as f:
+      for line in f:
+        if line.strip():
+          entry = json.loads(line)
+          history.setdefault(entry["scene"], []).append(entry)
+  return history
+
+# Fastest of 'runs' exports: (seconds, ok)
+def export(scene, inc_file, runs):
+  best = None
+  for i in range(runs):
+    start = time.perf_counter()
+    code = subprocess.call([converter_path, "--log-level", "error", scene, inc_file], stdout=subprocess.DEVNULL)
+    seconds = time.perf_counter() - start
+    if code != 0 or not os.path.exists(inc_file):
+      return seconds, False
+    best = seconds if best is None else min(best, seconds)
+  return best, True
+
+def check(name, seconds, inc_file, golden_file, past, opts):
+  if not os.path.exists(golden_file):
+    return "new", "no golden file, run with --update"
+
+  expected = sdl_lines(golden_file)
+  actual = sdl_lines(inc_file)
+  if actual != expected:
+    diff = list(difflib.unified_diff(expected, actual, "golden/" + name + ".inc", "out/" + name + ".inc", lineterm="", n=1))
+    return "diff", "\n".join(diff[:20] + (["..."] if len(diff) > 20 else []))
+
+  times = [e["seconds"] for e in past if e["result"] == "ok"][-opts["window"]:]
+  if times:
+    baseline = statistics.median(times)
+    if seconds > baseline * (1 + opts["threshold"] / 100) and seconds - baseline > min_slowdown:
+      return "slow", "%.3f s, baseline %.3f s (+%.0f%%)" % (seconds, baseline, 100 * (seconds / baseline - 1))
+  return "ok", ""
+
+def main():
+  opts = parse_args(sys.argv[1:])
+  scenes = sorted(glob.glob(os.path.join(scene_dir, "*.c4d")))
+  if opts["scenes"]:
+    scenes = [s for s in scenes if os.path.splitext(os.path.basename(s))[0] in opts["scenes"]]
+  os.makedirs(work_dir, exist_ok=True)
+
+  history = load_history()
+  commit = commit_id()
+  date = time.strftime("%Y-%m-%dT%H:%M:%S")
+  entries = []
+  failed = 0
+
+  print("\n%-32s %10s %12s  %s" % ("scene", "export s", "bytes", "result"))
+  for scene in scenes:
+    name = os.path.splitext(os.path.basename(scene))[0]
+    inc_file = os.path.join(work_dir, name + ".inc")
+    golden_file = os.path.join(golden_dir, name + ".inc")
+
+    seconds, ok = export(scene, inc_file, opts["runs"])
+    size = os.path.getsize(inc_file) if ok else 0
+    if not ok:
+      result, details = "failed", "export failed"
+    elif opts["update"]:
+      os.makedirs(golden_dir, exist_ok=True)
+      with open(inc_file, "rb") as src, open(golden_file, "wb") as dst:
+        dst.write(src.read())
+      result, details = "updated", ""
+    else:
+      result, details = check(name, seconds, inc_file, golden_file, history.get(name, []), opts)
+
+    print("%-32s %10.3f %12d  %s" % (name, seconds, size, result))
+    if details:
+      print("  " + details.replace("\n", "\n  "))
+    if result in ("failed", "new", "diff", "slow"):
+      failed += 1
+    entries.append({ "date": date, "commit": commit, "scene": name, "seconds": round(seconds, 6),
+                     "bytes": size, "result": "ok" if result == "updated" else result })
+
+  if opts["history"]:
+    with open(history_file, "a") as f:
+      for e in entries:
+        f.write(json.dumps(e) + "\n")
+
+  print("\n%d scenes, %d failed" % (len(entries), failed))
+  return 1 if failed else 0
+
+if __name__=='__main__':
+  sys.exit(main())
@@ -0,0 +1,107 @@
+#------------------------------------------------------------------------
+# Scaling benchmark of the exporter on synthetic scenes
+#
+# Grows one dimension of a generated scene at a time (mesh count, quads
+# per mesh, nesting depth, sweep path points, lights), writes the scenes
+# with 'cinema2pov --generate' and measures export time, peak memory and
+# output size. Results are printed per dimension and written to
+# out/scaling.csv for plotting.
+#
+# Usage: python scaling.py [runs] [dimension ...]
+#
+# CINEMA2POV environment variable overrides the executable.
+#------------------------------------------------------------------------
+import os
+import sys
+import time
+import subprocess
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+root_dir = os.path.dirname(base_dir)
+
+converter_path = os.environ.get("CINEMA2POV", os.path.join(root_dir, "cinema2pov.exe"))
+work_dir = os.path.join(base_dir, "out")
+
+# Dimension: fixed part of the spec, key grown and its values
+dimensions = {
+  "meshes": ("polys=400",           "meshes",  (10, 100, 1000, 10000)),
+  "polys":  ("meshes=4",            "polys",   (100, 10000, 100000, 1000000)),
+  "depth":  ("",                    "depth",   (10, 100, 1000, 5000)),
+  "points": ("splines=10",          "points",  (100, 1000, 10000, 100000)),
+  "lights": ("meshes=1",            "lights",  (1, 10, 100, 1000)),
+}
+
+def peak_rss_windows(proc):
+  import ctypes
+  from ctypes import wintypes
+
+  class Counters(ctypes.Structure):
+    _fields_ = [("cb", wintypes.DWORD), ("PageFaultCount", wintypes.DWORD),
+                ("PeakWorkingSetSize", ctypes.c_size_t), ("WorkingSetSize", ctypes.c_size_t),
+                ("QuotaPeakPagedPoolUsage", ctypes.c_size_t), ("QuotaPagedPoolUsage", ctypes.c_size_t),
+                ("QuotaPeakNonPagedPoolUsage", ctypes.c_size_t), ("QuotaNonPagedPoolUsage", ctypes.c_size_t),
+                ("PagefileUsage", ctypes.c_size_t), ("PeakPagefileUsage", ctypes.c_size_t)]
+
+  counters = Counters()
+  counters.cb = ctypes.sizeof(counters)
+  if not ctypes.windll.psapi.GetProcessMemoryInfo(int(proc._handle), ctypes.byref(counters), counters.cb):
+    return 0
+  return counters.PeakWorkingSetSize
+
+# Run command, returns (seconds, peak resident bytes, exit code)
+def measure(cmd):
+  start = time.perf_counter()
+  proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL)
+  if os.name == "nt":
+    proc.wait()
+    rss = peak_rss_windows(proc)
+    code = proc.returncode
+  else:
+    _, status, usage = os.wait4(proc.pid, 0)
+    proc.returncode = code = os.waitstatus_to_exitcode(status)
+    # ru_maxrss: kilobytes on Linux, bytes on macOS
+    rss = usage.ru_maxrss if sys.platform == "darwin" else usage.ru_maxrss * 1024
+  return time.perf_counter() - start, rss, code
+
+def run(spec, tag, runs):
+  c4d_file = os.path.join(work_dir, "scale_%s.c4d" % tag)
+  inc_file = os.path.join(work_dir, "scale_%s.inc" % tag)
+  if subprocess.call([converter_path, "--generate", spec, c4d_file], stdout=subprocess.DEVNULL) != 0:
+    return None
+
+  # Best of runs
+  best = None
+  for i in range(runs):
+    seconds, rss, code = measure([converter_path, "--log-level", "error", c4d_file, inc_file])
+    if code != 0:
+      return None
+    if not best or seconds < best[0]:
+      best = (seconds, rss)
+  return { "Export": best[0], "Peak RSS": best[1], "Input": os.path.getsize(c4d_file), "Output": os.path.getsize(inc_file) }
+
+def main():
+  runs = int(sys.argv[1]) if len(sys.argv) > 1 else 3
+  names = sys.argv[2:] or list(dimensions)
+  os.makedirs(work_dir, exist_ok=True)
+
+  rows = []
+  for name in names:
+    fixed, key, values = dimensions[name]
+    print("\n%-8s %10s %12s %12s %14s %10s" % (name, key, "export s", "peak MB", "output bytes", "MB/s"))
+    for value in values:
+      spec = ",".join(s for s in (fixed, "%s=%d" % (key, value)) if s)
+      r = run(spec, "%s_%d" % (name, value), runs)
+      if not r:
+        print("%-8s %10d %12s" % ("", value, "failed"))
+        continue
+      rate = r["Output"] / r["Export"] / (1 << 20) if r["Export"] else 0.0
+      print("%-8s %10d %12.3f %12.1f %14d %10.1f" % ("", value, r["Export"], r["Peak RSS"] / (1 << 20), r["Output"], rate))
+      rows.append((name, spec, r["Export"], r["Peak RSS"], r["Input"], r["Output"]))
+
+  with open(os.path.join(work_dir, "scaling.csv"), "w") as f:
+    f.write("dimension,spec,export_seconds,peak_rss_bytes,input_bytes,output_bytes\n")
+    for row in rows:
+      f.write('%s,"%s",%.6f,%d,%d,%d\n' % row)
+
+if __name__=='__main__':
+  main()
@@ -13,9 +13,21 @@
 #include "C4DImportExport.h"
 #include "c4d_browsecontainer.h"
 #include "parameter_ids/material/mbase.h"
+#include <climits>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "spline.h"
+#include "pov_format.h"
+#include "pov_output.h"
+#include "pov_mesh.h"
+#include "pov_curve.h"
+#include "pov_scene.h"
+#include "pov_log.h"
+#include "pov_cache.h"
+#include "pov_batch.h"
+#include "pov_watch.h"
 
 // here you should use the cineware namespace
 using namespace std;
@@ -23,16 +35,137 @@ using namespace cineware;
 
 // global temporary variables for this export example of c4d scene file
 BaseDocument* g_myInternalDoc = nullptr;  // pointer to the imported C4D document use to demonstrate the export, this should your own type of document
-Int32 g_tempLayID = 0;                    // also only for demonstration purposes, used to enumerate IDs and to assign as Layer IDs
-Int32 g_tempmatid = 0;                    // also only for demonstration purposes, used to enumerate IDs and to assign as Material IDs
 Char* version;
 
 ///
 // POV export globals
 //
-const size_t MAX_OBJ_NAME = 1024;
-vector<vector<string>> objects;
-FILE* file = 0;
+double g_weldEpsilon = -1.0;                // mesh point welding distance, off if negative
+unsigned g_threads = thread::hardware_concurrency();  // mesh data formatting threads
+double g_proxyRatio = 1.0;                  // proxy mesh triangle ratio, no proxies for 1
+double g_proxyError = 0.0;                  // proxy mesh max. error, no limit for 0
+bool g_mortonOrder = false;                 // sort mesh points and triangles along Morton curve
+double g_sweepTolerance = 0.0;              // sweep radius error, no points inserted for 0
+double g_splineTolerance = 0.0;             // spline resampling chord error, off for 0
+bool g_arcLengthKeys = false;               // key spline arrays by arc length, not index
+bool g_bounds = false;                      // bounded_by from exact object boxes
+
+NumberFormat g_floatFormat;                  // scene parameters, transforms, splines
+NumberFormat g_meshFormat(FLOAT_FIXED, 10);  // mesh2 data
+NumberFormat g_iconFormat(FLOAT_FIXED, 2);   // light icons
+
+//
+// Mesh written once, instanced by other objects with the same content
+//
+struct MeshEntry
+{
+  PolygonObject* op;
+  const Vector32* normals;  // owned by the mesh payload, valid until emitted
+  const Vector* uvs;        // per corner, in the scene arena
+  vector<Int32> ngons;
+  string name;
+};
+
+//
+// State of one export. Execute() functions and emitters reach it through
+// g_export; emitters running on worker threads write to their own sink.
+//
+struct ExportContext
+{
+  OutputSink* output = nullptr;                     // output file
+  Scene scene;                                      // scene IR, built by the Execute() functions
+  Int32 layId = 0;                                  // enumerates layers
+  Int32 matId = 0;                                  // enumerates materials
+  unordered_map<UInt64, vector<MeshEntry>> meshes;  // written meshes by content hash
+  Int32 meshCount = 0;
+  Int32 meshInstances = 0;
+  bool proxySwitch = false;                         // C2P_Proxy default written
+  atomic<long long> trianglesSaved{ 0 };            // against two triangles per polygon
+  ExportCache* cache = nullptr;                     // SDL of the previous export, nullptr if off
+
+  // Animation mode: document frame range, set by AlienBaseDocument::Execute()
+  bool animation = false;
+  string animFile;                                  // per-frame arrays, included by the output
+  Int32 fps = 0;
+  Int32 firstFrame = 0;
+  Int32 lastFrame = 0;
+};
+
+ExportContext* g_export = nullptr;
+thread_local OutputSink* sink = nullptr;            // output of the running emitter
+thread_local unsigned lineThreads = 1;              // WriteLines() threads of the running emitter
+
+//
+// Write helpers - formatting without printf format parsing, directly
+// into the buffer of the output sink
+//
+void WriteString(const char* str)
+{
+  sink->Write(str);
+}
+
+void WriteChars(const char* str, size_t len)
+{
+  sink->Write(str, len);
+}
+
+void WriteInt(long long v)
+{
+  char* p = sink->Reserve(MAX_NUMBER_CHARS);
+  sink->Commit(FormatInt(p, v));
+}
+
+void WriteFloat(double v, const NumberFormat& f = g_floatFormat)
+{
+  char* p = sink->Reserve(MAX_NUMBER_CHARS);
+  sink->Commit(FormatFloat(p, v, f));
+}
+
+void WriteVec3(double x, double y, double z, const NumberFormat& f = g_floatFormat)
+{
+  char* p = sink->Reserve(MAX_VECTOR_CHARS);
+  sink->Commit(FormatVec3(p, x, y, z, f));
+}
+
+// "  <x, y>" line, as used by prism and lathe point lists
+void WritePoint2(double x, double y)
+{
+  char* p = sink->Reserve(MAX_VECTOR_CHARS);
+  *p++ = ' ';
+  *p++ = ' ';
+  p = FormatVec2(p, x, y, g_floatFormat);
+  *p++ = '\n';
+  sink->Commit(p);
+}
+
+const size_t MAX_MATRIX_CHARS = 12 * MAX_NUMBER_CHARS + 64;
+
+//
+// Format matrix
+//
+char* FormatMatrix(char* out, const double* m)
+{
+  memcpy(out, "  matrix\n <", 11);
+  out += 11;
+  for (int i = 0; i < 4; i++)
+  {
+    out = FormatFloat(out, m[i * 3], g_floatFormat);
+    *out++ = ',';
+    *out++ = ' ';
+    out = FormatFloat(out, m[i * 3 + 1], g_floatFormat);
+    *out++ = ',';
+    *out++ = ' ';
+    out = FormatFloat(out, m[i * 3 + 2], g_floatFormat);
+    if (i < 3)
+    {
+      memcpy(out, ",\n  ", 4);
+      out += 4;
+    }
+  }
+  *out++ = '>';
+  *out++ = '\n';
+  return out;
+}
 
 //
 // Make valid object name
@@ -66,86 +199,521 @@ void MakeValidName(Char* objName)
 }
 
 //
-// Wtite matrix
+// Wtite matrix, of the current frame if animated
+//
+void WriteMatrix(const SceneNode* node)
+{
+  if (node->animMatrix)
+  {
+    WriteString("  C2P_Matrix(");
+    WriteString(node->animName);
+    WriteString("_M)\n");
+    return;
+  }
+
+  char* p = sink->Reserve(MAX_MATRIX_CHARS);
+  sink->Commit(FormatMatrix(p, node->matrix));
+}
+
+//
+// Parameter k of node times 'factor': the value, or the array element of
+// the current frame if the parameter is animated
+//
+void WriteParam(const SceneNode* node, int k, double value, double factor = 1.0)
+{
+  if (!(node->animParams & (1u << k)))
+  {
+    WriteFloat(factor * value);
+    return;
+  }
+
+  if (factor == -1.0)
+    WriteString("-");
+  else if (factor != 1.0)
+  {
+    WriteFloat(factor);
+    WriteString("*");
+  }
+  WriteString(node->animName);
+  WriteString("_P[C2P_Frame][");
+  WriteInt(k);
+  WriteString("]");
+}
+
+// Vector component: parameter k times c, or constant c if k < 0
+struct ParamTerm
+{
+  int k;
+  double c;
+};
+
+void WriteParamVec3(const SceneNode* node, const double* v, ParamTerm x, ParamTerm y, ParamTerm z)
+{
+  const ParamTerm* terms[3] = { &x, &y, &z };
+  WriteString("<");
+  for (int i = 0; i < 3; i++)
+  {
+    if (i > 0)
+      WriteString(", ");
+    if (terms[i]->k < 0)
+      WriteFloat(terms[i]->c);
+    else
+      WriteParam(node, terms[i]->k, v[terms[i]->k], terms[i]->c);
+  }
+  WriteString(">");
+}
+
+//
+// Wtite material
+//
+void WriteMaterial(const SceneNode* node)
+{
+  const char* material = g_export->scene.MaterialName(node->material);
+  if (material)
+  {
+    WriteString("\n  material { ");
+    WriteString(material);
+    WriteString(" }\n");
+  }
+}
+
+//
+// Object header: "#declare <name> = " for root objects
+//
+void WriteDeclare(const SceneNode* node)
+{
+  if (node->declared)
+  {
+    WriteString("#declare ");
+    WriteString(node->name);
+    WriteString(" = ");
+  }
+}
+
+//
+// Rounding step of written numbers, bounds are padded by it
+//
+double FormatStep(const NumberFormat& f)
+{
+  if (f.mode == FLOAT_QUANTIZED && f.quantum > 0.0)
+    return f.quantum;
+  return f.mode == FLOAT_FIXED ? pow(10.0, -f.precision) : 0.0;
+}
+
+//
+// bounded_by box of the node with --bounds. POV-Ray's own bounds of
+// meshes and primitives are exact already.
 //
-void WriteMatrix(BaseObject* op)
+void WriteBounds(const SceneNode* node)
 {
-  Matrix m = op->GetMl();
-  fprintf(file, "  matrix\n\
- <%lf, %lf, %lf,\n\
-  %lf, %lf, %lf,\n\
-  %lf, %lf, %lf,\n\
-  %lf, %lf, %lf>\n",
-    m.v1.x, m.v1.y, m.v1.z,
-    m.v2.x, m.v2.y, m.v2.z,
-    m.v3.x, m.v3.y, m.v3.z,
-    m.off.x, m.off.y, m.off.z);
+  if (!g_bounds || !node->bounded || node->bounds.Empty() || node->kind == NODE_MESH || node->kind == NODE_PRIMITIVE)
+    return;
+
+  const Bounds& b = node->bounds;
+  double pad = max(FormatStep(g_floatFormat), FormatStep(g_meshFormat));
+  for (int i = 0; i < 3; i++)
+    pad = max(pad, 1e-9 * (b.hi[i] - b.lo[i]));
+
+  WriteString("  bounded_by { box { ");
+  WriteVec3(b.lo[0] - pad, b.lo[1] - pad, b.lo[2] - pad);
+  WriteString(", ");
+  WriteVec3(b.hi[0] + pad, b.hi[1] + pad, b.hi[2] + pad);
+  WriteString(" } }\n");
 }
 
 //
-// Save object
+// Close object: root objects are placed by EmitScene(), others are
+// transformed here
 //
-void SaveObject(BaseObject* op)
+void WriteClose(const SceneNode* node)
 {
-  vector<string> item;
+  WriteBounds(node);
+  if (!node->declared)
+  {
+    WriteMatrix(node);
+    WriteMaterial(node);
+  }
+  WriteString("}\n\n");
+}
 
+//
+// Valid object name, interned in the scene
+//
+const char* ObjectName(BaseList2D* op)
+{
   Char* name = op->GetName().GetCStringCopy();
+  if (!name)
+    return "noname";
+
   MakeValidName(name);
-  item.push_back(name);
-
-  char matrix[MAX_OBJ_NAME] = { 0 };
-  Matrix m = op->GetMl();
-  sprintf(matrix, "\n  matrix\n\
- <%lf, %lf, %lf,\n\
-  %lf, %lf, %lf,\n\
-  %lf, %lf, %lf,\n\
-  %lf, %lf, %lf>\n",
-    m.v1.x, m.v1.y, m.v1.z,
-    m.v2.x, m.v2.y, m.v2.z,
-    m.v3.x, m.v3.y, m.v3.z,
-    m.off.x, m.off.y, m.off.z);
-
-  item.push_back(matrix);
-
-  char material[MAX_OBJ_NAME] = { 0 };
+  const char* interned = g_export->scene.Intern(name);
+  DeleteMem(name);
+  return interned;
+}
+
+//
+// ID of material assigned by texture tag, -1 if none. The name of each
+// material is read once.
+//
+int MaterialId(BaseObject* op)
+{
   BaseTag* pTex = op->GetTag(Ttexture);
-  if (pTex)
+  if (!pTex)
+    return -1;
+
+  GeData data;
+  if (!pTex->GetParameter(TEXTURETAG_MATERIAL, data))
+    return -1;
+
+  BaseMaterial* pMat = (BaseMaterial*)data.GetLink();
+  if (!pMat)
+    return -1;
+
+  Scene& scene = g_export->scene;
+  if (const int* id = scene.FindMaterial(pMat))
+    return *id;
+
+  Char* name = pMat->GetName().GetCStringCopy();
+  if (!name)
+    return -1;
+
+  int id = scene.AddMaterial(pMat, name);
+  DeleteMem(name);
+  return id;
+}
+
+//
+// Content hash of nodes: AddNode() hashes name, matrix and material, the
+// Execute() functions add everything their Emit() writes from the payload
+//
+void HashNode(SceneNode* node, const void* data, size_t len)
+{
+  node->hash = HashBytes(data, len, node->hash);
+}
+
+void HashNode(SceneNode* node, const char* str)
+{
+  HashNode(node, str, strlen(str) + 1);
+}
+
+template <class... T>
+void HashValues(SceneNode* node, const T&... v)
+{
+  (HashNode(node, &v, sizeof(v)), ...);
+}
+
+//
+// Add scene node of object: name, local matrix and material. Root objects
+// of 'declare' kinds are written as #declare and placed by EmitScene().
+//
+SceneNode* AddNode(SceneNodeKind kind, BaseObject* op, const char* name, SceneEmitter* emitter, bool declare)
+{
+  SceneNode* node = g_export->scene.Add(kind, op, op->GetUp(), emitter);
+  node->name = name;
+  node->material = MaterialId(op);
+  node->declared = declare && op->GetUp() == nullptr;
+
+  const Matrix& m = op->GetMl();
+  const Vector* rows[4] = { &m.v1, &m.v2, &m.v3, &m.off };
+  for (int i = 0; i < 4; i++)
+  {
+    node->matrix[i * 3]     = rows[i]->x;
+    node->matrix[i * 3 + 1] = rows[i]->y;
+    node->matrix[i * 3 + 2] = rows[i]->z;
+  }
+
+  bool material = node->material >= 0;
+  bool emits = emitter != nullptr;
+  HashValues(node, node->kind, node->declared, material, emits, node->matrix);
+  HashNode(node, name);
+  const char* materialName = g_export->scene.MaterialName(node->material);
+  HashNode(node, materialName ? materialName : "");
+  return node;
+}
+
+//
+// Emit nodes. Nulls and booleans emit their children, generators use
+// their child splines themselves, other children are grouped by
+// GroupScene().
+//
+void EmitNode(SceneNode* node)
+{
+  if (node->emitter)
+    node->emitter->Emit(node);
+}
+
+void EmitChildren(SceneNode* node)
+{
+  for (SceneNode* ch = node->child; ch; ch = ch->next)
+    EmitNode(ch);
+}
+
+//
+// Export cache key of object: its unique IDs as "<appid>:<hex>" pairs,
+// empty if it has none
+//
+static string UniqueIDKey(BaseList2D* op)
+{
+  string key;
+  Int32 cnt = op->GetUniqueIDCount();
+  for (Int32 i = 0; i < cnt; i++)
   {
-    GeData data;
-    AlienMaterial* pMat = nullptr;
-    if (pTex->GetParameter(TEXTURETAG_MATERIAL, data))
-      pMat = (AlienMaterial*)data.GetLink();
+    Int32 appid = 0;
+    Int bytes = 0;
+    const Char* mem = nullptr;
+    if (!op->GetUniqueIDIndex(i, appid, mem, bytes) || !mem)
+      continue;
+
+    char hex[3];
+    key += to_string(appid);
+    key += ':';
+    for (Int t = 0; t < bytes; t++)
+    {
+      sprintf(hex, "%2.2x", (UChar)mem[t]);
+      key += hex;
+    }
+    key += ' ';
+  }
+  return key;
+}
 
-    Char* pChar = pMat->GetName().GetCStringCopy();
-    sprintf(material, "\n  material { %s }\n", pChar);
-    DeleteMem(pChar);
+// Hash of node and its descendants
+static UInt64 SubtreeHash(const SceneNode* node, UInt64 h)
+{
+  h = HashBytes(&node->hash, sizeof(node->hash), h);
+  UInt64 children = 0;
+  for (const SceneNode* ch = node->child; ch; ch = ch->next, children++)
+    h = SubtreeHash(ch, h);
+  return HashBytes(&children, sizeof(children), h);
+}
+
+//
+// Bound nodes for bounded_by, children first. Animated parameters change
+// the shape, nodes with them stay unbounded. The brightness of lights
+// doesn't change their icons.
+//
+static void BoundNode(SceneNode* node)
+{
+  for (SceneNode* ch = node->child; ch; ch = ch->next)
+    BoundNode(ch);
+  node->bounds = Bounds();
+  node->bounded = node->emitter && (!node->animParams || node->kind == NODE_LIGHT) &&
+                  node->emitter->Bound(node, node->bounds);
+}
+
+void BoundScene(Scene& scene)
+{
+  for (SceneNode* node = scene.first; node; node = node->next)
+    BoundNode(node);
+}
+
+//
+// Box of the children of a union, difference or intersection 'csg' in the
+// space of 'node'. Cameras, splines and placeholders don't add geometry,
+// lights add their icons. A difference is bounded by its first child, an intersection
+// by the children that are bounded.
+//
+bool ChildBounds(const SceneNode* node, const char* csg, Bounds& bounds)
+{
+  bool difference = !strcmp(csg, "difference");
+  bool intersection = !strcmp(csg, "intersection");
+  bool known = false;
+  for (const SceneNode* ch = node->child; ch; ch = ch->next)
+  {
+    if (!ch->emitter || ch->kind == NODE_CAMERA || ch->kind == NODE_SPLINE)
+      continue;
+
+    bool valid = ch->bounded && !ch->animMatrix;
+    if (intersection)
+    {
+      if (!valid)
+        continue;
+      Bounds b = ch->bounds.Transformed(ch->matrix);
+      if (known)
+        bounds.Intersect(b);
+      else
+        bounds = b;
+      known = true;
+      continue;
+    }
+
+    if (!valid)
+      return false;
+    bounds.Add(ch->bounds.Transformed(ch->matrix));
+    if (difference)
+      break;
   }
-  
-  item.push_back(material);
+  return known || !intersection;
+}
+
+//
+// Children of objects that don't emit them - meshes, primitives, lights,
+// splines and not exported generators - are moved into a union after
+// their parent, placed by the parent's matrix. Generators keep their
+// child splines.
+//
+class GroupEmitter : public SceneEmitter
+{
+public:
+  virtual void Emit(SceneNode* node)
+  {
+    WriteString("union {\n\n");
+    EmitChildren(node);
+    WriteClose(node);
+  }
+
+  virtual bool Bound(const SceneNode* node, Bounds& bounds)
+  {
+    return ChildBounds(node, "union", bounds);
+  }
+};
 
-  objects.push_back(item);
+static GroupEmitter g_groupEmitter;
 
-  DeleteMem(name);
+static void GroupNode(Scene& scene, SceneNode* node)
+{
+  // Children first: their groups are then moved along with them
+  for (SceneNode* ch = node->child, *next; ch; ch = next)
+  {
+    next = ch->next;
+    GroupNode(scene, ch);
+  }
+
+  if (node->emitter && (node->kind == NODE_NULL || node->kind == NODE_BOOL))
+    return;
+
+  bool generator = node->kind == NODE_EXTRUDE || node->kind == NODE_SWEEP || node->kind == NODE_LATHE;
+  SceneNode* group = nullptr;
+  for (SceneNode* ch = node->child, *next; ch; ch = next)
+  {
+    next = ch->next;
+    if (generator && ch->kind == NODE_SPLINE)
+      continue;
+
+    if (!group)
+    {
+      group = scene.arena.New<SceneNode>();
+      group->kind = NODE_NULL;
+      group->name = node->name;
+      group->source = node->source;
+      group->emitter = &g_groupEmitter;
+      memcpy(group->matrix, node->matrix, sizeof(group->matrix));
+      group->animName = node->animName;
+      group->animMatrix = node->animMatrix;
+      HashValues(group, group->kind, group->matrix, group->animMatrix);
+      HashNode(group, group->name);
+      HashNode(group, group->animName ? group->animName : "");
+      scene.Move(group, node->parent, node);
+    }
+    scene.Move(ch, group);
+  }
+}
+
+void GroupScene(Scene& scene)
+{
+  for (SceneNode* node = scene.first, *next; node; node = next)
+  {
+    next = node->next;
+    GroupNode(scene, node);
+  }
+}
+
+static void SkipNode(SceneNode* node)
+{
+  if (node->emitter)
+    node->emitter->Skip(node);
+  for (SceneNode* ch = node->child; ch; ch = ch->next)
+    SkipNode(ch);
 }
 
 //
-// Wtite material
-// 
-// Closes object here. TODO: Close in Execute()
+// Second export phase: write top level objects, then place the declared
+// root objects. Top level subtrees are emitted in parallel and written in
+// document order. With the export cache, unchanged subtrees are copied
+// from it and the SDL of the others is recorded for the next export.
 //
-void WriteMaterial(BaseObject* op)
+void EmitScene(Scene& scene)
 {
-  BaseTag* pTex = op->GetTag(Ttexture);
-  if (pTex)
+  vector<SceneNode*> roots;
+  for (SceneNode* node = scene.first; node; node = node->next)
+    roots.push_back(node);
+
+  ExportCache* cache = g_export->cache;
+  vector<string> keys(roots.size());
+  vector<UInt64> hashes(roots.size());
+  vector<const string*> cached(roots.size());
+  vector<string> fresh(roots.size());
+  if (cache)
+  {
+    unordered_set<string> used;
+    for (size_t i = 0; i < roots.size(); i++)
+    {
+      // Objects without or with duplicated IDs are always emitted
+      keys[i] = UniqueIDKey((BaseList2D*)roots[i]->source);
+      if (keys[i].empty() || !used.insert(keys[i]).second)
+      {
+        keys[i].clear();
+        continue;
+      }
+      hashes[i] = SubtreeHash(roots[i], 0);
+      cached[i] = cache->Find(keys[i], hashes[i]);
+    }
+  }
+
+  // Emitters running side by side share the threads for their meshes
+  unsigned tasks = (unsigned)min<size_t>(max(1u, g_threads), max<size_t>(1, roots.size()));
+  unsigned threadsPerTask = max(1u, g_threads / tasks);
+
+  WriteTasks(*sink, roots.size(), g_threads, [&](OutputSink& out, size_t i)
   {
-    GeData data;
-    AlienMaterial* pMat = nullptr;
-    if (pTex->GetParameter(TEXTURETAG_MATERIAL, data))
-      pMat = (AlienMaterial*)data.GetLink();
+    lineThreads = threadsPerTask;
+    if (cached[i])
+    {
+      out.Write(cached[i]->data(), cached[i]->size());
+      SkipNode(roots[i]);
+      return;
+    }
+
+    OutputSink* prev = sink;
+    if (keys[i].empty())
+    {
+      sink = &out;
+      EmitNode(roots[i]);
+    }
+    else
+    {
+      OutputSink frag(0);
+      sink = &frag;
+      EmitNode(roots[i]);
+      out.Write(frag);
+      fresh[i].assign(frag.Data(), frag.Size());
+    }
+    sink = prev;
+  });
 
-    Char* name = pMat->GetName().GetCStringCopy();
-    fprintf(file, "\n  material { %s }\n", name);
-    DeleteMem(name);
+  if (cache)
+  {
+    for (size_t i = 0; i < roots.size(); i++)
+    {
+      if (cached[i])
+        cache->Keep(keys[i]);
+      else if (!keys[i].empty())
+        cache->Put(keys[i], hashes[i], move(fresh[i]));
+    }
+  }
+
+  for (SceneNode* node = scene.first; node; node = node->next)
+  {
+    if (!node->declared || !node->emitter)
+      continue;
+
+    WriteString("object{ ");
+    WriteString(node->name);
+    WriteString(" \n");
+    WriteMatrix(node);
+    WriteString(" ");
+    WriteMaterial(node);
+    WriteString("}\n\n");
   }
 }
 
@@ -181,13 +749,13 @@ bool HasSplineTag(BaseObject* obj, int& export_as, int& spline_type)
       if (btag->GetParameter(POV_SPLINE_EXPORT_AS, data))
       {
         export_as = data.GetInt32();
-        printf("- HasSplineTag: EXPORT_AS=%d\n", export_as);
+        LogTrace("- HasSplineTag: EXPORT_AS=%d\n", export_as);
       }
 
       if (btag->GetParameter(POV_SPLINE_SPLINE_TYPE, data))
       {
         spline_type = data.GetInt32();
-        printf("- HasSplineTag: SPLINE_TYPE=%d\n", spline_type);
+        LogTrace("- HasSplineTag: SPLINE_TYPE=%d\n", spline_type);
       }
 
       return true;
@@ -236,31 +804,31 @@ bool HasLightTag( BaseObject* obj, Float& tightness,
       if (btag->GetParameter(POV_LIGHT_TIGHTNESS, data))
       {
         tightness = data.GetFloat();
-        printf(" - HasLightTag: tightness=%f\n", tightness);
+        LogTrace(" - HasLightTag: tightness=%f\n", tightness);
       }
 
       if (btag->GetParameter(POV_LIGHT_FADE_DISTANCE, data))
       {
         fade_distance = data.GetFloat();
-        printf(" - HasLightTag: fade_distance=%f\n", fade_distance);
+        LogTrace(" - HasLightTag: fade_distance=%f\n", fade_distance);
       }
 
       if (btag->GetParameter(POV_LIGHT_FADE_POWER, data))
       {
         fade_power = data.GetFloat();
-        printf(" - HasLightTag: fade_power=%f\n", fade_power);
+        LogTrace(" - HasLightTag: fade_power=%f\n", fade_power);
       }
 
       if (btag->GetParameter(POV_LIGHT_AREA_NUM_X, data))
       {
         area_num_x = data.GetInt32();
-        printf(" - HasLightTag: area_num_x=%d\n", area_num_x);
+        LogTrace(" - HasLightTag: area_num_x=%d\n", area_num_x);
       }
 
       if (btag->GetParameter(POV_LIGHT_AREA_NUM_Y, data))
       {
         area_num_y = data.GetInt32();
-        printf(" - HasLightTag: area_num_y=%d\n", area_num_y);
+        LogTrace(" - HasLightTag: area_num_y=%d\n", area_num_y);
       }
 
       if (btag->GetParameter(POV_LIGHT_PROJECTED_THROUGH, data))
@@ -268,43 +836,43 @@ bool HasLightTag( BaseObject* obj, Float& tightness,
         String str = data.GetString();
         if(str.GetLength())
           projected_through  = str.GetCStringCopy();
-        printf(" - HasLightTag: projected_through ='%s'\n", projected_through.c_str());
+        LogTrace(" - HasLightTag: projected_through ='%s'\n", projected_through.c_str());
       }
 
       if (btag->GetParameter(POV_LIGHT_ICON_TRANSPARENCY, data))
       {
         icon_tranparency = data.GetFloat();
-        printf(" - HasLightTag: icon_tranparency=%f\n", icon_tranparency);
+        LogTrace(" - HasLightTag: icon_tranparency=%f\n", icon_tranparency);
       }
 
       if (btag->GetParameter(POV_LIGHT_ICON_SCALE, data))
       {
         icon_scale = data.GetFloat();
-        printf(" - HasLightTag: icon_scale=%f\n", icon_scale);
+        LogTrace(" - HasLightTag: icon_scale=%f\n", icon_scale);
       }
 
       if (btag->GetParameter(POV_LIGHT_DISPLAY_ICON, data))
       {
         disply_icon = data.GetBool();
-        printf(" - HasLightTag: disply_icon=%d\n", disply_icon);
+        LogTrace(" - HasLightTag: disply_icon=%d\n", disply_icon);
       }
 
       if (btag->GetParameter(POV_LIGHT_PARALLEL, data))
       {
         parallel = data.GetBool();
-        printf(" - HasLightTag: parallel=%d\n", parallel);
+        LogTrace(" - HasLightTag: parallel=%d\n", parallel);
       }
 
       if (btag->GetParameter(POV_LIGHT_MEDIA_ATTENUATION, data))
       {
         media_attenuation = data.GetBool();
-        printf(" - HasLightTag: media_attenuation=%d\n", media_attenuation);
+        LogTrace(" - HasLightTag: media_attenuation=%d\n", media_attenuation);
       }
 
       if (btag->GetParameter(POV_LIGHT_MEDIA_INTERACTION, data))
       {
         media_interaction = data.GetBool();
-        printf(" - HasLightTag: media_interaction=%d\n", media_interaction);
+        LogTrace(" - HasLightTag: media_interaction=%d\n", media_interaction);
       }
 
       return true;
@@ -369,6 +937,9 @@ void GetWriterInfo(Int32& id, String& appname)
 // print UIDs for all existing application IDs
 static void PrintUniqueIDs(BaseList2D* op)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   // actual UIDs - size can be different from application to application
   Int32 t = 0;
   Int32 i = 0;
@@ -386,19 +957,22 @@ static void PrintUniqueIDs(BaseList2D* op)
         CriticalStop();
         continue;
       }
-      printf("   - UniqueID (%d Byte): ",(int)bytes);
+      LogTrace("   - UniqueID (%d Byte): ",(int)bytes);
       for (t = 0; t < bytes; t++)
       {
-        printf("%2.2x",(UChar)mem[t]);
+        LogTrace("%2.2x",(UChar)mem[t]);
       }
-      printf(" [AppID: %d]",(int)appid);
-      printf("\n");
+      LogTrace(" [AppID: %d]",(int)appid);
+      LogTrace("\n");
     }
   }
 }
 
 static void PrintUniqueIDs(NodeData *op)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   if (op)
     PrintUniqueIDs(op->GetNode());
 }
@@ -406,6 +980,9 @@ static void PrintUniqueIDs(NodeData *op)
 // shows how to access user data
 static void PrintUserData(BaseList2D* bl)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   if (!bl)
     return;
 
@@ -451,7 +1028,7 @@ static void PrintUserData(BaseList2D* bl)
         if (bl->GetDataInstanceRef().GetParameter(id, data) && data.GetType() == DA_VECTOR)
           vecVal = data.GetVector();
 
-        printf("   - User Data: %s (type=%d) - %f/%f/%f (default=%f/%f/%f)\n", name, type, vecVal.x, vecVal.y, vecVal.z, vecDef.x, vecDef.y, vecDef.z);
+        LogTrace("   - User Data: %s (type=%d) - %f/%f/%f (default=%f/%f/%f)\n", name, type, vecVal.x, vecVal.y, vecVal.z, vecDef.x, vecDef.y, vecDef.z);
       }
       else if (type == DA_LONG)
       {
@@ -462,7 +1039,7 @@ static void PrintUserData(BaseList2D* bl)
         if (bl->GetDataInstanceRef().GetParameter(id, data) && data.GetType() == DA_LONG)
           intVal = data.GetInt32();
 
-        printf("   - User Data: %s (type=%d) - %d (default=%d)\n", name, type, intVal, intDef);
+        LogTrace("   - User Data: %s (type=%d) - %d (default=%d)\n", name, type, intVal, intDef);
       }
       else if (type == DA_REAL)
       {
@@ -473,7 +1050,7 @@ static void PrintUserData(BaseList2D* bl)
         if (bl->GetDataInstanceRef().GetParameter(id, data) && data.GetType() == DA_REAL)
           floatVal = data.GetFloat();
 
-        printf("   - User Data: %s (type=%d) - %f (default=%f)\n", name, type, floatVal, floatDef);
+        LogTrace("   - User Data: %s (type=%d) - %f (default=%f)\n", name, type, floatVal, floatDef);
       }
       else if (type == DA_STRING)
       {
@@ -485,11 +1062,11 @@ static void PrintUserData(BaseList2D* bl)
           strVal = data.GetString().GetCStringCopy();
 
         if (strVal && strDef)
-          printf("   - User Data: %s (type=%d) - \"%s\" (default=\"%s\")\n", name, type, strVal, strDef);
+          LogTrace("   - User Data: %s (type=%d) - \"%s\" (default=\"%s\")\n", name, type, strVal, strDef);
         else if (strVal)
-          printf("   - User Data: %s (type=%d) - \"%s\"\n", name, type, strVal);
+          LogTrace("   - User Data: %s (type=%d) - \"%s\"\n", name, type, strVal);
         else
-          printf("   - User Data: %s (type=%d) - \"\"\n", name, type);
+          LogTrace("   - User Data: %s (type=%d) - \"\"\n", name, type);
 
         DeleteMem(strDef);
         DeleteMem(strVal);
@@ -497,7 +1074,7 @@ static void PrintUserData(BaseList2D* bl)
       else
       {
         // types we do not cover here
-        printf("   - User Data: %s - (%d) <unknown type>\n", name, type);
+        LogTrace("   - User Data: %s - (%d) <unknown type>\n", name, type);
       }
 
       DeleteMem(name);
@@ -506,13 +1083,16 @@ static void PrintUserData(BaseList2D* bl)
     // free the browse data
     desc->BrowseFree(handle);
 
-    printf("\n");
+    LogTrace("\n");
   }
 }
 
 // prints tag infos to the console
 static void PrintTagInfo(BaseObject* obj)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   if (!obj)
     return;
 
@@ -527,12 +1107,12 @@ static void PrintTagInfo(BaseObject* obj)
     pChar = btag->GetName().GetCStringCopy();
     if (pChar)
     {
-      printf("   - %s \"%s\"", GetObjectTypeName(btag->GetType()), pChar);
+      LogTrace("   - %s \"%s\"", GetObjectTypeName(btag->GetType()), pChar);
       DeleteMem(pChar);
     }
     else
     {
-      printf("   - %s \"\"", GetObjectTypeName(btag->GetType()));
+      LogTrace("   - %s \"\"", GetObjectTypeName(btag->GetType()));
     }
 
     // compositing tag
@@ -541,21 +1121,21 @@ static void PrintTagInfo(BaseObject* obj)
       if (btag->GetParameter(COMPOSITINGTAG_MATTEOBJECT, data) && data.GetInt32())
       {
         if (btag->GetParameter(COMPOSITINGTAG_MATTECOLOR, data))
-          printf("     + Matte - Color R %d G %d B %d", (int)(data.GetVector().x*255.0), (int)(data.GetVector().y*255.0), (int)(data.GetVector().z*255.0));
+          LogTrace("     + Matte - Color R %d G %d B %d", (int)(data.GetVector().x*255.0), (int)(data.GetVector().y*255.0), (int)(data.GetVector().z*255.0));
         else
-          printf("     + Matte - Color NOCOLOR");
+          LogTrace("     + Matte - Color NOCOLOR");
       }
       if (btag->GetParameter(COMPOSITINGTAG_ENABLECHN4, data) && data.GetInt32())
       {
         if (btag->GetParameter(COMPOSITINGTAG_IDCHN4, data))
-          printf("     + Objectbuffer Channel 5 enabled - ID = %d", (int)data.GetInt32());
+          LogTrace("     + Objectbuffer Channel 5 enabled - ID = %d", (int)data.GetInt32());
       }
     }
     // phong tag
     if (btag->GetType() == Tphong)
     {
       if (btag->GetParameter(PHONGTAG_PHONG_ANGLE, data))
-        printf(" - Phong Angle = %f", data.GetFloat()*180.0/PI);
+        LogTrace(" - Phong Angle = %f", data.GetFloat()*180.0/PI);
     }
 
     // archi grass tag
@@ -569,21 +1149,21 @@ static void PrintTagInfo(BaseObject* obj)
         char *pCharGM = mat->GetName().GetCStringCopy();
         if (pCharGM)
         {
-          printf(" - material: \"%s\"", pCharGM);
+          LogTrace(" - material: \"%s\"", pCharGM);
           DeleteMem(pCharGM);
         }
         else
         {
-          printf(" - material: <grass mat>");
+          LogTrace(" - material: <grass mat>");
         }
 
-        printf("\n    ");
+        LogTrace("\n    ");
         if (mat->GetParameter(GRASS_LENGTH, data))
-          printf(" - Len = %f", data.GetFloat());
+          LogTrace(" - Len = %f", data.GetFloat());
         if (mat->GetParameter(GRASS_DENSITY, data))
-          printf(" - Den = %f", data.GetFloat());
+          LogTrace(" - Den = %f", data.GetFloat());
         if (mat->GetParameter(GRASS_WIDTH, data))
-          printf(" - Wth = %f", data.GetFloat());
+          LogTrace(" - Wth = %f", data.GetFloat());
       }
     }
 
@@ -594,7 +1174,7 @@ static void PrintTagInfo(BaseObject* obj)
       if (targetObj)
       {
         targetObj->GetName().GetCString(buffer, sizeof buffer);
-        printf(" - linked to \"%s\"", buffer);
+        LogTrace(" - linked to \"%s\"", buffer);
       }
     }
 
@@ -603,7 +1183,7 @@ static void PrintTagInfo(BaseObject* obj)
     {
       if (btag->GetParameter(ALIGNTOPATHTAG_LOOKAHEAD, data))
       {
-        printf(" - Look Ahead: %f", data.GetTime().Get());
+        LogTrace(" - Look Ahead: %f", data.GetTime().Get());
       }
     }
 
@@ -612,7 +1192,7 @@ static void PrintTagInfo(BaseObject* obj)
     {
       if (btag->GetParameter(VIBRATEEXPRESSION_RELATIVE, data))
       {
-        printf(" - Relative: %d", (int)data.GetInt32());
+        LogTrace(" - Relative: %d", (int)data.GetInt32());
       }
     }
 
@@ -622,7 +1202,7 @@ static void PrintTagInfo(BaseObject* obj)
       if (btag->GetParameter(1000, data))
       {
         pChar = data.GetString().GetCStringCopy();
-        printf("     Code:\n---\n%s\n---\n", pChar);
+        LogTrace("     Code:\n---\n%s\n---\n", pChar);
         DeleteMem(pChar);
       }
     }
@@ -633,13 +1213,13 @@ static void PrintTagInfo(BaseObject* obj)
       if (btag->GetParameter(WWWTAG_URL, data))
       {
         pChar = data.GetString().GetCStringCopy();
-        printf("     URL:  \"%s\"", pChar);
+        LogTrace("     URL:  \"%s\"", pChar);
         DeleteMem(pChar);
       }
       if (btag->GetParameter(WWWTAG_INFO, data))
       {
         pChar = data.GetString().GetCStringCopy();
-        printf("     INFO: \"%s\"", pChar);
+        LogTrace("     INFO: \"%s\"", pChar);
         DeleteMem(pChar);
       }
     }
@@ -652,7 +1232,7 @@ static void PrintTagInfo(BaseObject* obj)
       {
         Int32 pCnt = 0;
         Int32 jCnt = wt->GetJointCount();
-        printf(" - Joint Count: %d\n", (int)jCnt);
+        LogTrace(" - Joint Count: %d\n", (int)jCnt);
 
         BaseObject *jOp = nullptr;
         // print data for 3 joints and 3 points only
@@ -662,30 +1242,30 @@ static void PrintTagInfo(BaseObject* obj)
           if (jOp)
           {
             pChar = jOp->GetName().GetCStringCopy();
-            printf("     Joint %d: \"%s\"\n", (int)j, pChar);
+            LogTrace("     Joint %d: \"%s\"\n", (int)j, pChar);
             DeleteMem(pChar);
           }
-          printf("     Joint Weight Count:  %d\n", (int)wt->GetWeightCount(j));
+          LogTrace("     Joint Weight Count:  %d\n", (int)wt->GetWeightCount(j));
           if (obj->GetType() == Opolygon)
           {
             pCnt = ((PolygonObject*)obj)->GetPointCount();
             for (Int32 p = 0; p < pCnt && p < 3; p++)
             {
-              printf("     Weight at Point %d: %f\n", (int)p, wt->GetWeight(j,p));
+              LogTrace("     Weight at Point %d: %f\n", (int)p, wt->GetWeight(j,p));
             }
             if (pCnt >= 3)
-              printf("     ...\n");
+              LogTrace("     ...\n");
           }
         }
         if (jCnt >= 3 && pCnt < 3)
-          printf("     ...\n");
+          LogTrace("     ...\n");
       }
     }
 
     // SDS weight tag
     if (btag->GetType() == Tsds)
     {
-      printf("\n");
+      LogTrace("\n");
       HNWeightTagData* sds = (HNWeightTagData*)btag->GetNodeData();
       if (sds)
       {
@@ -694,10 +1274,10 @@ static void PrintTagInfo(BaseObject* obj)
         {
           for (Int32 p = 0; p < *sdsData.points && p < 6; p++)
           {
-            printf("     SDS Weight at Vertex %d: %f\n", (int)p, (*sdsData.pointweight)[p]);
+            LogTrace("     SDS Weight at Vertex %d: %f\n", (int)p, (*sdsData.pointweight)[p]);
           }
           if (*sdsData.points >= 6)
-            printf("     ...\n");
+            LogTrace("     ...\n");
         }
       }
     }
@@ -719,11 +1299,11 @@ static void PrintTagInfo(BaseObject* obj)
         pCharMat = mat->GetName().GetCStringCopy();
         if (pCharMat)
         {
-          printf(" - material: \"%s\" (%d/%d/%d)", pCharMat, int(col.x*255), int(col.y*255), int(col.z*255));
+          LogTrace(" - material: \"%s\" (%d/%d/%d)", pCharMat, int(col.x*255), int(col.y*255), int(col.z*255));
           DeleteMem(pCharMat);
         }
         else
-          printf(" - material: <noname> (%d/%d/%d)", int(col.x*255), int(col.y*255), int(col.z*255));
+          LogTrace(" - material: <noname> (%d/%d/%d)", int(col.x*255), int(col.y*255), int(col.z*255));
         // detect the shader
         BaseShader* sh = mat->GetShader(MATERIAL_COLOR_SHADER);
         if (sh)
@@ -731,23 +1311,23 @@ static void PrintTagInfo(BaseObject* obj)
           pCharSh = sh->GetName().GetCStringCopy();
           if (pCharSh)
           {
-            printf(" - color shader \"%s\" - Type: %s", pCharSh, GetObjectTypeName(sh->GetType()));
+            LogTrace(" - color shader \"%s\" - Type: %s", pCharSh, GetObjectTypeName(sh->GetType()));
             DeleteMem(pCharSh);
           }
           else
-            printf(" - color shader <noname> - Type: %s", GetObjectTypeName(sh->GetType()));
+            LogTrace(" - color shader <noname> - Type: %s", GetObjectTypeName(sh->GetType()));
         }
         else
-          printf(" - no shader");
+          LogTrace(" - no shader");
       }
       else
-        printf(" - no material");
+        LogTrace(" - no material");
     }
 
     // normal tag
     if (btag->GetType() == Tnormal)
     {
-      printf("\n");
+      LogTrace("\n");
       Int32 count = ((NormalTag*)btag)->GetDataCount();
       const CPolygon *pAdr = nullptr;
       if (obj->GetType() == Opolygon)
@@ -758,32 +1338,32 @@ static void PrintTagInfo(BaseObject* obj)
       for (Int32 n = 0; normalsPtr && n < count && n < 2; n++)
       {
         NormalTag::Get(normalsPtr, n, pNormals);
-        printf("     Na %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.a.x, pNormals.a.y, pNormals.a.z);
-        printf("     Nb %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.b.x, pNormals.b.y, pNormals.b.z);
-        printf("     Nc %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.c.x, pNormals.c.y, pNormals.c.z);
+        LogTrace("     Na %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.a.x, pNormals.a.y, pNormals.a.z);
+        LogTrace("     Nb %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.b.x, pNormals.b.y, pNormals.b.z);
+        LogTrace("     Nc %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.c.x, pNormals.c.y, pNormals.c.z);
         if (!pAdr || pAdr[n].c != pAdr[n].d)
-          printf("     Nd %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.d.x, pNormals.d.y, pNormals.d.z);
+          LogTrace("     Nd %d: %.6f / %.6f / %.6f\n", (int)n, pNormals.d.x, pNormals.d.y, pNormals.d.z);
       }
     }
 
     // UVW tag
     if (btag->GetType() == Tuvw)
     {
-      printf("\n");
+      LogTrace("\n");
       UVWStruct uvw;
       Int32 uvwCount = ((UVWTag*)btag)->GetDataCount();
       // print for 4 polys uvw infos
       for (Int32 u = 0; u < uvwCount && u < 4; u++)
       {
         ((UVWTag*)btag)->Get(((UVWTag*)btag)->GetDataAddressR(), u, uvw);
-        printf("     Poly %d: %.2f %.2f %.2f / %.2f %.2f %.2f / %.2f %.2f %.2f / %.2f %.2f %.2f \n", (int)u, uvw.a.x, uvw.a.y, uvw.a.z, uvw.b.x, uvw.b.y, uvw.b.z, uvw.c.x, uvw.c.y, uvw.c.z, uvw.d.x, uvw.d.y, uvw.d.z);
+        LogTrace("     Poly %d: %.2f %.2f %.2f / %.2f %.2f %.2f / %.2f %.2f %.2f / %.2f %.2f %.2f \n", (int)u, uvw.a.x, uvw.a.y, uvw.a.z, uvw.b.x, uvw.b.y, uvw.b.z, uvw.c.x, uvw.c.y, uvw.c.z, uvw.d.x, uvw.d.y, uvw.d.z);
       }
     }
 
     // Polygon Selection Tag
     if (btag->GetType() == Tpolygonselection && obj->GetType() == Opolygon)
     {
-      printf("\n");
+      LogTrace("\n");
       BaseSelect *bs = ((SelectionTag*)btag)->GetBaseSelect();
       if (bs)
       {
@@ -791,19 +1371,19 @@ static void PrintTagInfo(BaseObject* obj)
         for (s = 0; s<((PolygonObject*)obj)->GetPolygonCount() && s < 5; s++)
         {
           if (bs->IsSelected(s))
-            printf("     Poly %d: selected\n", (int)s);
+            LogTrace("     Poly %d: selected\n", (int)s);
           else
-            printf("     Poly %d: NOT selected\n", (int)s);
+            LogTrace("     Poly %d: NOT selected\n", (int)s);
         }
         if (s < ((PolygonObject*)obj)->GetPolygonCount())
-          printf("     ...\n");
+          LogTrace("     ...\n");
       }
     }
 
     // Vertex Map tag
     if (btag->GetType() == Tvertexmap)
     {
-      printf("\n");
+      LogTrace("\n");
       Int32 vCount = ((VertexMapTag*)btag)->GetDataCount();
       // print the vertex map infos for the first 3 points
       const Float32* values = ((VertexMapTag*)btag)->GetDataAddressR();
@@ -811,7 +1391,7 @@ static void PrintTagInfo(BaseObject* obj)
       {
         for (Int32 v = 0; v < vCount && v < 3; v++)
         {
-          printf("     Point %d: %f\n", (int)v, values[v]);
+          LogTrace("     Point %d: %f\n", (int)v, values[v]);
         }
       }
     }
@@ -819,7 +1399,7 @@ static void PrintTagInfo(BaseObject* obj)
     // Vertex Color tag
     if (btag->GetType() == Tvertexcolor)
     {
-      printf("\n");
+      LogTrace("\n");
       Int32 pCount = ((PolygonObject*)obj)->GetPolygonCount();
       const CPolygon* polys = ((PolygonObject*)obj)->GetPolygonR();
       // print the vertex map infos for the first 3 points
@@ -830,11 +1410,11 @@ static void PrintTagInfo(BaseObject* obj)
         for (Int32 pIdx = 0; pIdx < pCount && pIdx < 3; pIdx++)
         {
           ((VertexColorTag*)btag)->Get(vcPtr, pIdx, vcs);
-          printf("     Poly %d Vertex 1: %f / %f / %f\n", pIdx, vcs.a.x, vcs.a.y, vcs.a.z);
-          printf("     Poly %d Vertex 2: %f / %f / %f\n", pIdx, vcs.b.x, vcs.b.y, vcs.b.z);
-          printf("     Poly %d Vertex 3: %f / %f / %f\n", pIdx, vcs.c.x, vcs.c.y, vcs.c.z);
+          LogTrace("     Poly %d Vertex 1: %f / %f / %f\n", pIdx, vcs.a.x, vcs.a.y, vcs.a.z);
+          LogTrace("     Poly %d Vertex 2: %f / %f / %f\n", pIdx, vcs.b.x, vcs.b.y, vcs.b.z);
+          LogTrace("     Poly %d Vertex 3: %f / %f / %f\n", pIdx, vcs.c.x, vcs.c.y, vcs.c.z);
           if (polys[pIdx].c != polys[pIdx].d)
-            printf("     Poly %d Vertex 4: %f / %f / %f\n", pIdx, vcs.d.x, vcs.d.y, vcs.d.z);
+            LogTrace("     Poly %d Vertex 4: %f / %f / %f\n", pIdx, vcs.d.x, vcs.d.y, vcs.d.z);
         }
       }
     }
@@ -842,7 +1422,7 @@ static void PrintTagInfo(BaseObject* obj)
     // Display tag
     if (btag->GetType() == Tdisplay)
     {
-      printf("\n");
+      LogTrace("\n");
 
       btag->GetParameter(DISPLAYTAG_AFFECT_LEVELOFDETAIL, data);
       const Bool aLod = data.GetBool();
@@ -864,27 +1444,30 @@ static void PrintTagInfo(BaseObject* obj)
       const Bool aGl = data.GetBool();
       btag->GetParameter(DISPLAYTAG_HQ_OGL, data);
       const Bool eGl = data.GetBool();
-      printf("     (Used/Value) LOD:%d/%d VIS:%d/%d BFC:%d/%d TEX:%d/%d OGL:%d/%d\n", aLod, Int32(vLod * 100.0), aVis, Int32(vVis * 100.0), aBfc, eBfc, aTex, eTex, aGl, eGl);
+      LogTrace("     (Used/Value) LOD:%d/%d VIS:%d/%d BFC:%d/%d TEX:%d/%d OGL:%d/%d\n", aLod, Int32(vLod * 100.0), aVis, Int32(vVis * 100.0), aBfc, eBfc, aTex, eTex, aGl, eGl);
     }
 
     PrintUserData(btag);
 
-    printf("\n");
+    LogTrace("\n");
   }
 }
 
 // shows how to access parameters of 3 different shader types and prints it to the console
 static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   BaseShader *sh = shader;
   while (sh)
   {
-    for (Int32 s=0; s<depth; s++) printf(" ");
+    for (Int32 s=0; s<depth; s++) LogTrace(" ");
 
     // type layer shader
     if (sh->GetType() == Xlayer)
     {
-      printf("LayerShader - %d\n", (int)sh->GetType());
+      LogTrace("LayerShader - %d\n", (int)sh->GetType());
 
       BaseContainer* pData = sh->GetDataInstance();
       GeData blendData = pData->GetData(SLA_LAYER_BLEND);
@@ -895,9 +1478,9 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
 
         while (lsl)
         {
-          for (Int32 s=0; s<depth; s++) printf(" ");
+          for (Int32 s=0; s<depth; s++) LogTrace(" ");
 
-          printf(" LayerShaderLayer - %s (%d)\n", GetObjectTypeName(lsl->GetType()), lsl->GetType());
+          LogTrace(" LayerShaderLayer - %s (%d)\n", GetObjectTypeName(lsl->GetType()), lsl->GetType());
 
           // folder ?
           if (lsl->GetType() == TypeFolder)
@@ -905,8 +1488,8 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
             LayerShaderLayer *subLsl = (LayerShaderLayer*)((BlendFolder*)lsl)->m_Children.GetObject(0);
             while (subLsl)
             {
-              for (Int32 s=0; s<depth; s++) printf(" ");
-              printf("  Shader - %s (%d)\n", GetObjectTypeName(subLsl->GetType()), subLsl->GetType());
+              for (Int32 s=0; s<depth; s++) LogTrace(" ");
+              LogTrace("  Shader - %s (%d)\n", GetObjectTypeName(subLsl->GetType()), subLsl->GetType());
 
               // base shader ?
               if (subLsl->GetType() == TypeShader)
@@ -928,41 +1511,41 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
       Char *pCharShader =  sh->GetFileName().GetString().GetCStringCopy();
       if (pCharShader)
       {
-        printf("Shader - %s (%d) : %s\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType(), pCharShader);
+        LogTrace("Shader - %s (%d) : %s\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType(), pCharShader);
         DeleteMem(pCharShader);
         pCharShader =  sh->GetFileName().GetFileString().GetCStringCopy();
         if (pCharShader)
         {
-          for (Int32 s=0; s<depth; s++) printf(" ");
-          printf("texture name only: \"%s\"\n", pCharShader);
+          for (Int32 s=0; s<depth; s++) LogTrace(" ");
+          LogTrace("texture name only: \"%s\"\n", pCharShader);
           DeleteMem(pCharShader);
         }
       }
       else
       {
-        printf("Shader - %s (%d) : ""\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
+        LogTrace("Shader - %s (%d) : ""\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
       }
     }
     // type gradient shader
     else if (sh->GetType() == Xgradient)
     {
-      printf("Shader - %s (%d) : ", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
+      LogTrace("Shader - %s (%d) : ", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
       GeData data;
       sh->GetParameter(SLA_GRADIENT_GRADIENT, data);
       Gradient *pGrad = (Gradient*)data.GetCustomDataType(CUSTOMDATATYPE_GRADIENT);
       Int32 kcnt = pGrad->GetKnotCount();
-      printf(" %d Knots\n", (int)kcnt);
+      LogTrace(" %d Knots\n", (int)kcnt);
       for (Int32 k = 0; k < kcnt; k++)
       {
         GradientKnot kn = pGrad->GetKnot(k);
-        for (Int32 s=0; s<depth; s++) printf(" ");
-        printf("   -> %d. Knot: %.1f/%.1f/%.1f\n", (int)k, kn.col.x*255.0, kn.col.y*255.0, kn.col.z*255.0);
+        for (Int32 s=0; s<depth; s++) LogTrace(" ");
+        LogTrace("   -> %d. Knot: %.1f/%.1f/%.1f\n", (int)k, kn.col.x*255.0, kn.col.y*255.0, kn.col.z*255.0);
       }
     }
     // type variation shader
     else if (sh->GetType() == Xvariation)
     {
-      printf("Shader - %s (%d)\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
+      LogTrace("Shader - %s (%d)\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
       VariationShaderData* vData = (VariationShaderData*)sh->GetNodeData();
       if (vData)
       {
@@ -970,7 +1553,7 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
         for (Int32 t = 0; t < texCnt; t++)
         {
           TextureLayer lay = vData->GetTextureLayer(t);
-          printf("   -> Layer: type: %s  active: %d  prop: %f\n", lay._shader ? GetObjectTypeName(lay._shader->GetType()) : "<nullptr>", lay._active, lay._probability);
+          LogTrace("   -> Layer: type: %s  active: %d  prop: %f\n", lay._shader ? GetObjectTypeName(lay._shader->GetType()) : "<nullptr>", lay._active, lay._probability);
           if (lay._shader)
           {
             if (lay._shader->GetType() == Xbitmap)
@@ -978,7 +1561,7 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
               Char *pChar = lay._shader->GetFileName().GetString().GetCStringCopy();
               if (pChar)
               {
-                printf("       -> Texture: %s\n", pChar);
+                LogTrace("       -> Texture: %s\n", pChar);
                 DeleteMem(pChar);
               }
             }
@@ -987,7 +1570,7 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
       }
       else
       {
-        printf("Shader - %s (%d)\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
+        LogTrace("Shader - %s (%d)\n", GetObjectTypeName(sh->GetType()), (int)sh->GetType());
 
         PrintShaderInfo(sh->GetDown(), depth+1);
       }
@@ -1000,10 +1583,13 @@ static void PrintShaderInfo(BaseShader *shader, Int32 depth = 0)
 // shows how to access render data parameter and prints it to the console
 static void PrintRenderDataInfo(RenderData *rdata)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   if (!rdata)
     return;
 
-  printf("\n\n # Render Data #\n");
+  LogTrace("\n\n # Render Data #\n");
 
   GeData data;
   // renderer
@@ -1012,29 +1598,29 @@ static void PrintRenderDataInfo(RenderData *rdata)
     switch (data.GetInt32())
     {
       case RDATA_RENDERENGINE_PREVIEWSOFTWARE:
-        printf(" - Renderengine - PREVIEWSOFTWARE\n");
+        LogTrace(" - Renderengine - PREVIEWSOFTWARE\n");
         break;
 
       case RDATA_RENDERENGINE_PREVIEWHARDWARE:
-        printf(" - Renderengine - PREVIEWHARDWARE\n");
+        LogTrace(" - Renderengine - PREVIEWHARDWARE\n");
         break;
 
       case RDATA_RENDERENGINE_CINEMAN:
-        printf(" - Renderengine - CINEMAN\n");
+        LogTrace(" - Renderengine - CINEMAN\n");
         break;
 
       case RDATA_RENDERENGINE_STANDARD:
-        printf(" - Renderengine - STANDARD\n");
+        LogTrace(" - Renderengine - STANDARD\n");
 
       default:
-        printf(" - Renderengine - Unknown ID: %d\n", data.GetInt32());
+        LogTrace(" - Renderengine - Unknown ID: %d\n", data.GetInt32());
     }
   }
 
   // save option on/off ?
   if (rdata->GetParameter(RDATA_GLOBALSAVE, data) && data.GetInt32())
   {
-    printf(" - Global Save - ENABLED\n");
+    LogTrace(" - Global Save - ENABLED\n");
     if (rdata->GetParameter(RDATA_SAVEIMAGE, data) && data.GetInt32())
     {
       if (rdata->GetParameter(RDATA_PATH, data))
@@ -1042,34 +1628,34 @@ static void PrintRenderDataInfo(RenderData *rdata)
         Char *pChar = data.GetFilename().GetString().GetCStringCopy();
         if (pChar)
         {
-          printf("   + Save Image - %s\n", pChar);
+          LogTrace("   + Save Image - %s\n", pChar);
           DeleteMem(pChar);
         }
         else
-          printf("   + Save Image\n");
+          LogTrace("   + Save Image\n");
       }
       else
-        printf("   + Save Image\n");
+        LogTrace("   + Save Image\n");
     }
     // save options: alpha, straight alpha, separate alpha, dithering, sound
     if (rdata->GetParameter(RDATA_ALPHACHANNEL, data) && data.GetInt32())
-      printf("   + Alpha Channel\n");
+      LogTrace("   + Alpha Channel\n");
     if (rdata->GetParameter(RDATA_STRAIGHTALPHA, data) && data.GetInt32())
-      printf("   + Straight Alpha\n");
+      LogTrace("   + Straight Alpha\n");
     if (rdata->GetParameter(RDATA_SEPARATEALPHA, data) && data.GetInt32())
-      printf("   + Separate Alpha\n");
+      LogTrace("   + Separate Alpha\n");
     if (rdata->GetParameter(RDATA_TRUECOLORDITHERING, data) && data.GetInt32())
-      printf("   + 24 Bit Dithering\n");
+      LogTrace("   + 24 Bit Dithering\n");
     if (rdata->GetParameter(RDATA_INCLUDESOUND, data) && data.GetInt32())
-      printf("   + Include Sound\n");
+      LogTrace("   + Include Sound\n");
   }
   else
-    printf(" - Global Save = false\n");
+    LogTrace(" - Global Save = false\n");
 
   // multi pass enabled ?
   if (rdata->GetParameter(RDATA_MULTIPASS_ENABLE, data) && data.GetInt32())
   {
-    printf(" - Multi pass - ENABLED\n");
+    LogTrace(" - Multi pass - ENABLED\n");
     if (rdata->GetParameter(RDATA_MULTIPASS_SAVEIMAGE, data) && data.GetInt32())
     {
       if (rdata->GetParameter(RDATA_MULTIPASS_FILENAME, data))
@@ -1077,18 +1663,18 @@ static void PrintRenderDataInfo(RenderData *rdata)
         Char *pChar = data.GetFilename().GetString().GetCStringCopy();
         if (pChar)
         {
-          printf("   + Save Multi pass Image - %s\n", pChar);
+          LogTrace("   + Save Multi pass Image - %s\n", pChar);
           DeleteMem(pChar);
         }
         else
-          printf("   + Save Multi pass Image\n");
+          LogTrace("   + Save Multi pass Image\n");
       }
       else
-        printf("   + Save Multi pass Image\n");
+        LogTrace("   + Save Multi pass Image\n");
     }
 
     if (rdata->GetParameter(RDATA_MULTIPASS_STRAIGHTALPHA, data) && data.GetInt32())
-      printf("   + Multi pass Straight Alpha\n");
+      LogTrace("   + Multi pass Straight Alpha\n");
     MultipassObject *mobj = rdata->GetFirstMultipass();
 
     if (mobj)
@@ -1097,14 +1683,14 @@ static void PrintRenderDataInfo(RenderData *rdata)
       {
         if (mobj->GetParameter(MULTIPASSOBJECT_TYPE, data))
         {
-          printf("   + Multi pass Channel: %d", (int)data.GetInt32());
+          LogTrace("   + Multi pass Channel: %d", (int)data.GetInt32());
           if (data.GetInt32() == VPBUFFER_OBJECTBUFFER)
           {
             if (mobj->GetParameter(MULTIPASSOBJECT_OBJECTBUFFER, data))
-              printf(" Group ID %d", (int)data.GetInt32());
+              LogTrace(" Group ID %d", (int)data.GetInt32());
           }
 
-          printf("\n");
+          LogTrace("\n");
           mobj = (MultipassObject*)mobj->GetNext();
         }
       }
@@ -1113,139 +1699,142 @@ static void PrintRenderDataInfo(RenderData *rdata)
   // print out enabled post effects
   BaseVideoPost *vp = rdata->GetFirstVideoPost();
   if (vp)
-    printf( " - VideoPostEffects:\n");
+    LogTrace( " - VideoPostEffects:\n");
   while (vp)
   {
     // enabled / disabled ?
-    printf("   + %s ", vp->GetBit(BIT_VPDISABLED) ? "[OFF]" : "[ON ]");
+    LogTrace("   + %s ", vp->GetBit(BIT_VPDISABLED) ? "[OFF]" : "[ON ]");
 
     switch (vp->GetType())
     {
       case VPambientocclusion:
-        printf("Ambient Occlusion");
+        LogTrace("Ambient Occlusion");
         if (vp->GetParameter(VPAMBIENTOCCLUSION_ACCURACY, data) && data.GetType() == DA_REAL)
-          printf(" (Accuracy = %f)", (100.0 * data.GetFloat()));
+          LogTrace(" (Accuracy = %f)", (100.0 * data.GetFloat()));
         break;
       case VPcomic:
-        printf("Celrender");
+        LogTrace("Celrender");
         if (vp->GetParameter(VP_COMICOUTLINE, data) && data.GetType() == DA_LONG)
-          printf(" (Outline = %s)", data.GetInt32() ? "true" : "false");
+          LogTrace(" (Outline = %s)", data.GetInt32() ? "true" : "false");
         break;
       case VPcolorcorrection:
-        printf("Color correction");
+        LogTrace("Color correction");
         if (vp->GetParameter(ID_PV_FILTER_CONTRAST, data) && data.GetType() == DA_REAL)
-          printf(" (Contrast = %f)", (100.0 * data.GetFloat()));
+          LogTrace(" (Contrast = %f)", (100.0 * data.GetFloat()));
         break;
       case VPcolormapping:
-        printf("Color mapping");
+        LogTrace("Color mapping");
         if (vp->GetParameter(COLORMAPPING_BACKGROUND, data) && data.GetType() == DA_LONG)
-          printf(" (Affect Background = %s)", data.GetInt32() ? "true" : "false");
+          LogTrace(" (Affect Background = %s)", data.GetInt32() ? "true" : "false");
         break;
       case VPcylindricallens:
-        printf("Cylindrical Lens");
+        LogTrace("Cylindrical Lens");
         if (vp->GetParameter(CYLINDERLENS_VERTICALSIZE, data) && data.GetType() == DA_REAL)
-          printf(" (Vertical Size = %f)", data.GetFloat());
+          LogTrace(" (Vertical Size = %f)", data.GetFloat());
         break;
       case VPopticsuite_depthoffield:
-        printf("Depth of Field");
+        LogTrace("Depth of Field");
         if (vp->GetParameter(DB_DBLUR, data) && data.GetType() == DA_REAL)
-          printf(" (Distance Blur = %f)", 100*data.GetFloat());
+          LogTrace(" (Distance Blur = %f)", 100*data.GetFloat());
         break;
       case VPglobalillumination:
-        printf("Global Illumination");
+        LogTrace("Global Illumination");
         if (vp->GetParameter(GI_SETUP_DATA_EXTRA_REFLECTIVECAUSTICS, data) && data.GetType() == DA_LONG)
-          printf(" (Reflective Caustics = %s)", data.GetInt32() ? "true" : "false");
+          LogTrace(" (Reflective Caustics = %s)", data.GetInt32() ? "true" : "false");
         if (vp->GetParameter(GI_SETUP_DATA_PRESETS, data) && data.GetType() == DA_LONG)
-          printf(" (GI Preset = %d)", data.GetInt32());
+          LogTrace(" (GI Preset = %d)", data.GetInt32());
         break;
       case VPopticsuite_glow:
-        printf("Glow");
+        LogTrace("Glow");
         if (vp->GetParameter(GW_LUM, data) && data.GetType() == DA_REAL)
-          printf(" (Luminosity = %f)", 100*data.GetFloat());
+          LogTrace(" (Luminosity = %f)", 100*data.GetFloat());
         break;
       case VPhair:
-        printf("Hair");
+        LogTrace("Hair");
         if (vp->GetParameter(HAIR_RENDER_SHADOW_DIST_ACCURACY, data) && data.GetType() == DA_REAL)
-          printf(" (Depth Threshold = %f)", 100*data.GetFloat());
+          LogTrace(" (Depth Threshold = %f)", 100*data.GetFloat());
         break;
       case VPopticsuite_highlights:
-        printf("Highlights");
+        LogTrace("Highlights");
         if (vp->GetParameter(HLIGHT_SIZE, data) && data.GetType() == DA_REAL)
-          printf(" (Flare Size = %f)", 100*data.GetFloat());
+          LogTrace(" (Flare Size = %f)", 100*data.GetFloat());
         break;
       case VPlenseffects:
-        printf("Lens effects");
+        LogTrace("Lens effects");
         break;
       case VPmedianfilter:
-        printf("Median filter");
+        LogTrace("Median filter");
         if (vp->GetParameter(VP_MEDIANFILTERSTRENGTH, data) && data.GetType() == DA_REAL)
-          printf(" (Strength = %f)", 100*data.GetFloat());
+          LogTrace(" (Strength = %f)", 100*data.GetFloat());
         break;
       case VPobjectglow:
-        printf("Object glow");
+        LogTrace("Object glow");
         break;
       case VPobjectmotionblur:
-        printf("Object motion blur");
+        LogTrace("Object motion blur");
         if (vp->GetParameter(VP_OMBSTRENGTH, data) && data.GetType() == DA_REAL)
-          printf(" (Strength = %f)", 100*data.GetFloat());
+          LogTrace(" (Strength = %f)", 100*data.GetFloat());
         break;
       case VPsharpenfilter:
-        printf("Sharpen filter");
+        LogTrace("Sharpen filter");
         if (vp->GetParameter(VP_SHARPENFILTERSTRENGTH, data) && data.GetType() == DA_REAL)
-          printf(" (Strength = %f)", 100*data.GetFloat());
+          LogTrace(" (Strength = %f)", 100*data.GetFloat());
         break;
       case VPscenemotionblur:
-        printf("Scene motion blur");
+        LogTrace("Scene motion blur");
         if (vp->GetParameter(VP_SMBDITHER, data) && data.GetType() == DA_REAL)
-          printf(" (Dithering = %f)", 100*data.GetFloat());
+          LogTrace(" (Dithering = %f)", 100*data.GetFloat());
         vp->SetParameter(VP_SMBDITHER, 12.3*0.01); // set test
         break;
       case VPremote:
-        printf("Remote");
+        LogTrace("Remote");
         if (vp->GetParameter(VP_REMOTEPATH, data) && data.GetType() == DA_FILENAME)
         {
           Char *tmp = data.GetFilename().GetString().GetCStringCopy();
-          printf(" (Ext. Appl. = \'%s\')", tmp);
+          LogTrace(" (Ext. Appl. = \'%s\')", tmp);
           DeleteMem(tmp);
         }
         break;
       case VPsketch:
-        printf("Sketch & Toon");
+        LogTrace("Sketch & Toon");
         if (vp->GetParameter(OUTLINEMAT_LINE_INTERSECTION, data) && data.GetType() == DA_LONG)
-          printf(" (Intersections = %s)", data.GetInt32() ? "true" : "false");
+          LogTrace(" (Intersections = %s)", data.GetInt32() ? "true" : "false");
         break;
       case VPsoftfilter:
-        printf("Soft filter");
+        LogTrace("Soft filter");
         if (vp->GetParameter(VP_SOFTFILTERSTRENGTH, data) && data.GetType() == DA_REAL)
-          printf(" (Strength = %f)", 100*data.GetFloat());
+          LogTrace(" (Strength = %f)", 100*data.GetFloat());
         break;
       case VPvectormotionblur:
-        printf("Vector motion blur");
+        LogTrace("Vector motion blur");
         if (vp->GetParameter(MBLUR_SAMPLES, data) && data.GetType() == DA_LONG)
-          printf(" (Samples = %d)", (int) data.GetInt32());
+          LogTrace(" (Samples = %d)", (int) data.GetInt32());
         break;
       case VPToneMapping:
-        printf("Tome-Mapper");
+        LogTrace("Tome-Mapper");
         break;
       default:
-        printf("Unknown ID: %d", vp->GetType());
+        LogTrace("Unknown ID: %d", vp->GetType());
         break;
     }
-    printf("\n");
+    LogTrace("\n");
 
     vp = (BaseVideoPost*)vp->GetNext();
   }
 
-  printf("\n");
+  LogTrace("\n");
 }
 
 // prints animation track and key infos to the console
 static void PrintAnimInfo(BaseList2D* bl)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   if (!bl || !bl->GetFirstCTrack())
     return;
 
-  printf("\n   # Animation Info #");
+  LogTrace("\n   # Animation Info #");
 
   Int32 tn = 0;
   CTrack* ct = bl->GetFirstCTrack();
@@ -1255,21 +1844,21 @@ static void PrintAnimInfo(BaseList2D* bl)
     Char* pChar = ct->GetName().GetCStringCopy();
     if (pChar)
     {
-      printf("\n   %d. CTrack \"%s\"!\n", (int)++tn, pChar);
+      LogTrace("\n   %d. CTrack \"%s\"!\n", (int)++tn, pChar);
       DeleteMem(pChar);
     }
     else
-      printf("\n   %d. CTrack !\n", (int)++tn);
+      LogTrace("\n   %d. CTrack !\n", (int)++tn);
 
     // time track
     CTrack* tt = ct->GetTimeTrack(bl->GetDocument());
     if (tt)
     {
-      printf("\n   -> has TimeTrack !\n");
+      LogTrace("\n   -> has TimeTrack !\n");
       CCurve* tcc = ct->GetCurve();
       if (tcc)
       {
-        printf("    Has CCurve with %d Keys\n", (int)tcc->GetKeyCount());
+        LogTrace("    Has CCurve with %d Keys\n", (int)tcc->GetKeyCount());
 
         CKey* ck = nullptr;
         BaseTime t;
@@ -1277,7 +1866,7 @@ static void PrintAnimInfo(BaseList2D* bl)
         {
           ck = tcc->GetKey(k);
           t = ck->GetTime();
-          printf("     %d. Key : %d - %f\n", (int)k + 1, (int)t.GetFrame(25), ck->GetValue());
+          LogTrace("     %d. Key : %d - %f\n", (int)k + 1, (int)t.GetFrame(25), ck->GetValue());
         }
       }
     }
@@ -1285,23 +1874,23 @@ static void PrintAnimInfo(BaseList2D* bl)
     // get DescLevel id
     DescID testID = ct->GetDescriptionID();
     DescLevel lv = testID[0];
-    printf("   DescID->DescLevel->ID: %d\n", (int)lv.id);
+    LogTrace("   DescID->DescLevel->ID: %d\n", (int)lv.id);
 
     // CTrack type
     switch (ct->GetTrackCategory())
     {
     case PSEUDO_VALUE:
-      printf("   VALUE - Track found!\n");
+      LogTrace("   VALUE - Track found!\n");
       break;
 
     case PSEUDO_DATA:
-      printf("   DATA - Track found!\n");
+      LogTrace("   DATA - Track found!\n");
       break;
 
     case PSEUDO_PLUGIN:
       if (ct->GetType() == CTpla)
       {
-        printf("   PLA - Track found!\n");
+        LogTrace("   PLA - Track found!\n");
 
         CCurve* cc = ct->GetCurve();
         if (cc && cc->GetKeyCount() > 0)
@@ -1339,29 +1928,29 @@ static void PrintAnimInfo(BaseList2D* bl)
 
             // get first point
             Vector point = pAdr[0];
-            printf("    1. Point of Key 1: %f %f %f\n", point.x, point.y, point.z);
+            LogTrace("    1. Point of Key 1: %f %f %f\n", point.x, point.y, point.z);
           }
         }
 
       }
       else if (ct->GetType() == CTdynamicspline)
-        printf("   Dynamic Spline Data - Track found!\n");
+        LogTrace("   Dynamic Spline Data - Track found!\n");
       else if (ct->GetType() == CTmorph)
-        printf("   MORPH - Track found!\n");
+        LogTrace("   MORPH - Track found!\n");
       else
-        printf("   unknown PLUGIN - Track found!\n");
+        LogTrace("   unknown PLUGIN - Track found!\n");
       break;
 
     case PSEUDO_UNDEF:
     default:
-      printf("   UNDEFINDED - Track found!\n");
+      LogTrace("   UNDEFINDED - Track found!\n");
     }
 
     // get CCurve and print key frame data
     CCurve* cc = ct->GetCurve();
     if (cc)
     {
-      printf("   Has CCurve with %d Keys\n", (int)cc->GetKeyCount());
+      LogTrace("   Has CCurve with %d Keys\n", (int)cc->GetKeyCount());
 
       CKey* ck = nullptr;
       BaseTime t;
@@ -1372,7 +1961,7 @@ static void PrintAnimInfo(BaseList2D* bl)
         t = ck->GetTime();
         if (ct->GetTrackCategory() == PSEUDO_VALUE)
         {
-          printf("    %d. Key : %d - Value (Float): %f\n", (int)k + 1, (int)t.GetFrame(25), ck->GetValue());
+          LogTrace("    %d. Key : %d - Value (Float): %f\n", (int)k + 1, (int)t.GetFrame(25), ck->GetValue());
         }
         else if (ct->GetTrackCategory() == PSEUDO_DATA)
         {
@@ -1380,25 +1969,25 @@ static void PrintAnimInfo(BaseList2D* bl)
 
           if (data.GetType() == DA_LONG)
           {
-            printf("    %d. Key : %d - Data Long: %d\n", (int)k + 1, (int)t.GetFrame(25), data.GetInt32());
+            LogTrace("    %d. Key : %d - Data Long: %d\n", (int)k + 1, (int)t.GetFrame(25), data.GetInt32());
           }
           else if (data.GetType() == DA_REAL)
           {
-            printf("    %d. Key : %d - Data Float: %f\n", (int)k + 1, (int)t.GetFrame(25), data.GetFloat());
+            LogTrace("    %d. Key : %d - Data Float: %f\n", (int)k + 1, (int)t.GetFrame(25), data.GetFloat());
           }
         }
         else if (ct->GetTrackCategory() == PSEUDO_PLUGIN && ct->GetType() == CTpla)
         {
           GeData ptData;
-          printf("    %d. Key : %d - ", (int)k + 1, (int)t.GetFrame(25));
+          LogTrace("    %d. Key : %d - ", (int)k + 1, (int)t.GetFrame(25));
 
           // bias
           if (ck->GetParameter(CK_PLA_BIAS, ptData) && ptData.GetType() == DA_REAL)
-            printf("Bias = %.2f - ", ptData.GetFloat());
+            LogTrace("Bias = %.2f - ", ptData.GetFloat());
 
           // smooth
           if (ck->GetParameter(CK_PLA_CUBIC, ptData) && ptData.GetType() == DA_LONG)
-            printf("Smooth = %d - ", (int)ptData.GetInt32());
+            LogTrace("Smooth = %d - ", (int)ptData.GetInt32());
 
           // pla data
           if (ck->GetParameter(CK_PLA_DATA, ptData))
@@ -1411,26 +2000,26 @@ static void PrintAnimInfo(BaseList2D* bl)
             {
               Vector* a = poiTag->GetPointAdr();
               // print values for first point only
-              printf("%.3f / %.3f / %.3f", a[0].x, a[0].y, a[0].z);
+              LogTrace("%.3f / %.3f / %.3f", a[0].x, a[0].y, a[0].z);
             }
             else
-              printf("no points?");
+              LogTrace("no points?");
           }
 
-          printf("\n");
+          LogTrace("\n");
         }
         else if (ct->GetTrackCategory() == PSEUDO_PLUGIN && ct->GetType() == CTmorph)
         {
           GeData mtData;
-          printf("    %d. Key : %d - ", (int)k + 1, (int)t.GetFrame(25));
+          LogTrace("    %d. Key : %d - ", (int)k + 1, (int)t.GetFrame(25));
 
           // bias
           if (ck->GetParameter(CK_MORPH_BIAS, mtData) && mtData.GetType() == DA_REAL)
-            printf("Bias = %.2f - ", mtData.GetFloat());
+            LogTrace("Bias = %.2f - ", mtData.GetFloat());
 
           // smooth
           if (ck->GetParameter(CK_MORPH_CUBIC, mtData) && mtData.GetType() == DA_LONG)
-            printf("Smooth = %d - ", (int)mtData.GetInt32());
+            LogTrace("Smooth = %d - ", (int)mtData.GetInt32());
 
           // link to target object
           if (ck->GetParameter(CK_MORPH_LINK, mtData))
@@ -1441,30 +2030,33 @@ static void PrintAnimInfo(BaseList2D* bl)
               Char* pTargetChar = targetObject->GetName().GetCStringCopy();
               if (pTargetChar)
               {
-                printf("Target Object = %s", pTargetChar);
+                LogTrace("Target Object = %s", pTargetChar);
                 DeleteMem(pTargetChar);
               }
               else
-                printf("no target object name");
+                LogTrace("no target object name");
             }
             else
-              printf("no target object defined...");
+              LogTrace("no target object defined...");
           }
 
-          printf("\n");
+          LogTrace("\n");
         }
       } // for
 
     }
     ct = ct->GetNext();
   }
-  printf("\n");
+  LogTrace("\n");
 }
 
 // print matrix data to the console
 static void PrintMatrix(Matrix m)
 {
-  printf("   - Matrix:");
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
+  LogTrace("   - Matrix:");
   Int32 size = 6;
   Float f = m.v1.x;
   if (f == 0.0)
@@ -1479,8 +2071,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v1.y;
   if (f == 0.0)
@@ -1495,8 +2087,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v1.z;
   if (f == 0.0)
@@ -1511,10 +2103,10 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f\n",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f\n",f);
 
-  printf("           :");
+  LogTrace("           :");
   size = 6;
   f = m.v2.x;
   if (f == 0.0)
@@ -1529,8 +2121,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v2.y;
   if (f == 0.0)
@@ -1545,8 +2137,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v2.z;
   if (f == 0.0)
@@ -1561,10 +2153,10 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f\n",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f\n",f);
 
-  printf("           :");
+  LogTrace("           :");
   size = 6;
   f = m.v3.x;
   if (f == 0.0)
@@ -1579,8 +2171,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v3.y;
   if (f == 0.0)
@@ -1595,8 +2187,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.v3.z;
   if (f == 0.0)
@@ -1611,10 +2203,10 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f\n",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f\n",f);
 
-  printf("           :");
+  LogTrace("           :");
   size = 6;
   f = m.off.x;
   if (f == 0.0)
@@ -1629,8 +2221,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.off.y;
   if (f == 0.0)
@@ -1645,8 +2237,8 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f",f);
   size = 6;
   f = m.off.z;
   if (f == 0.0)
@@ -1661,32 +2253,215 @@ static void PrintMatrix(Matrix m)
     size--;
   if (f >= 10000.0 || f <= -10000.0)
     size--;
-  for (Int32 s=0; s<size; s++) printf(" ");
-  printf("%f\n",f);
+  for (Int32 s=0; s<size; s++) LogTrace(" ");
+  LogTrace("%f\n",f);
 }
 
 // example function to get the load progress
 inline void myLoadProgressFunction(Int32 status, void *udata)
 {
   Int32 test = status;  // read percentage of the file (0 - 100)
-  printf("%d",(int)test);
-  printf("%%");
-  printf(".");
+  LogTrace("%d",(int)test);
+  LogTrace("%%");
+  LogTrace(".");
 }
 
 // example function to get the save progress
 inline void mySaveProgressFunction(Int32 status, void *udata)
 {
   Int32 test = status;  // actual written file size in bytes
-  printf("%d",(int)test);
-  printf(".");
+  LogTrace("%d",(int)test);
+  LogTrace(".");
 }
 
-// loads the scene with name <fn> and if cache exist saves it as <fnback>
-static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
+//
+// Animation export
+//
+// Objects with animation tracks are evaluated at every frame of the
+// document range. Those whose matrix or emitted parameters change are
+// animated: their values go to per-frame arrays in a second include,
+// indexed by frame_number, and their SDL refers to the arrays. Everything
+// else is static and written once, as without animation.
+//
+
+// Set value tracks of object to 'time'
+static void ApplyTracks(BaseObject* op, BaseDocument* doc, const BaseTime& time, Int32 fps)
 {
-  if (!fn)
-    return false;
+  for (CTrack* ct = op->GetFirstCTrack(); ct; ct = ct->GetNext())
+  {
+    if (ct->GetTrackCategory() != PSEUDO_VALUE)
+      continue;
+
+    Float value = ct->GetValue(doc, time, fps);
+    const DescID& id = ct->GetDescriptionID();
+    Int32 param = id[0].id;
+    if (id.GetDepth() == 2 &&
+        (param == ID_BASEOBJECT_REL_POSITION || param == ID_BASEOBJECT_REL_ROTATION || param == ID_BASEOBJECT_REL_SCALE))
+    {
+      Vector v = param == ID_BASEOBJECT_REL_POSITION ? op->GetRelPos() :
+                 param == ID_BASEOBJECT_REL_ROTATION ? op->GetRelRot() : op->GetRelScale();
+      switch (id[1].id)
+      {
+        case VECTOR_X: v.x = value; break;
+        case VECTOR_Y: v.y = value; break;
+        case VECTOR_Z: v.z = value; break;
+      }
+      if (param == ID_BASEOBJECT_REL_POSITION)
+        op->SetRelPos(v);
+      else if (param == ID_BASEOBJECT_REL_ROTATION)
+        op->SetRelRot(v);
+      else
+        op->SetRelScale(v);
+    }
+    else
+      op->SetParameter(id, GeData(value));
+  }
+}
+
+static void CollectAnimated(SceneNode* node, vector<SceneNode*>& nodes)
+{
+  for (; node; node = node->next)
+  {
+    if (node->emitter && ((BaseObject*)node->source)->GetFirstCTrack())
+      nodes.push_back(node);
+    CollectAnimated(node->child, nodes);
+  }
+}
+
+// "#declare <name> = array[frames][n] {" rows "}"
+static void WriteFrameArray(const char* name, const char* suffix, const vector<double>& samples, size_t frames, int stride, int first, int n)
+{
+  WriteString("#declare ");
+  WriteString(name);
+  WriteString(suffix);
+  WriteString(" = array[");
+  WriteInt(frames);
+  WriteString("][");
+  WriteInt(n);
+  WriteString("] {\n");
+  for (size_t f = 0; f < frames; f++)
+  {
+    const double* row = &samples[f * stride + first];
+    WriteString("  {");
+    for (int i = 0; i < n; i++)
+    {
+      if (i > 0)
+        WriteString(", ");
+      WriteFloat(row[i]);
+    }
+    WriteString(f + 1 < frames ? "},\n" : "}\n");
+  }
+  WriteString("}\n");
+}
+
+static void SampleAnimation(BaseDocument* doc, Scene& scene)
+{
+  ExportContext* ctx = g_export;
+  if (ctx->fps <= 0)
+  {
+    LogWarn("\n # Animation: document has no frame rate, exporting frame 0 only\n");
+    return;
+  }
+
+  vector<SceneNode*> nodes;
+  CollectAnimated(scene.first, nodes);
+
+  OutputSink out;
+  if (!out.Open(ctx->animFile.c_str(), false))
+  {
+    LogError("\n # Can't open animation file: %s\n", ctx->animFile.c_str());
+    return;
+  }
+
+  size_t frames = ctx->lastFrame >= ctx->firstFrame ? ctx->lastFrame - ctx->firstFrame + 1 : 1;
+  OutputSink* prev = sink;
+  sink = &out;
+  WriteString("// Animation: frames ");
+  WriteInt(ctx->firstFrame);
+  WriteString(" - ");
+  WriteInt(ctx->firstFrame + (long long)frames - 1);
+  WriteString(" at ");
+  WriteInt(ctx->fps);
+  WriteString(" fps\n\n#declare C2P_Frames = ");
+  WriteInt(frames);
+  WriteString(";\n#ifndef (C2P_Frame)\n  #declare C2P_Frame = min(max(frame_number - ");
+  WriteInt(ctx->firstFrame);
+  WriteString(", 0), C2P_Frames - 1);\n#end\n\n#macro C2P_Matrix(M)\n  matrix <");
+  for (int i = 0; i < 12; i++)
+  {
+    WriteString(i > 0 ? ", M[C2P_Frame][" : "M[C2P_Frame][");
+    WriteInt(i);
+    WriteString("]");
+  }
+  WriteString(">\n#end\n\n");
+
+  size_t animated = 0;
+  for (SceneNode* node : nodes)
+  {
+    BaseObject* op = (BaseObject*)node->source;
+    const int stride = 12 + MAX_ANIM_PARAMS;
+    vector<double> samples(frames * stride);
+    int params = 0;
+    for (size_t f = 0; f < frames; f++)
+    {
+      ApplyTracks(op, doc, BaseTime((Float)(ctx->firstFrame + (Int32)f), (Float)ctx->fps), ctx->fps);
+
+      double* row = &samples[f * stride];
+      const Matrix& m = op->GetMl();
+      const Vector* rows[4] = { &m.v1, &m.v2, &m.v3, &m.off };
+      for (int i = 0; i < 4; i++)
+      {
+        row[i * 3]     = rows[i]->x;
+        row[i * 3 + 1] = rows[i]->y;
+        row[i * 3 + 2] = rows[i]->z;
+      }
+      params = node->emitter->Animate(node, row + 12);
+    }
+
+    for (size_t f = 1; f < frames; f++)
+    {
+      const double* row = &samples[f * stride];
+      if (memcmp(row, &samples[0], 12 * sizeof(double)))
+        node->animMatrix = true;
+      for (int k = 0; k < params; k++)
+        if (row[12 + k] != samples[12 + k])
+          node->animParams |= 1u << k;
+    }
+    if (!node->animMatrix && !node->animParams)
+      continue;
+
+    string name = string("C2P_") + node->name + "_" + to_string(animated++);
+    node->animName = scene.Intern(name);
+    HashNode(node, node->animName);
+    HashValues(node, node->animMatrix, node->animParams);
+
+    WriteString("// ");
+    WriteString(node->name);
+    WriteString("\n");
+    if (node->animMatrix)
+      WriteFrameArray(node->animName, "_M", samples, frames, stride, 0, 12);
+    if (node->animParams)
+      WriteFrameArray(node->animName, "_P", samples, frames, stride, 12, params);
+    WriteString("\n");
+  }
+  sink = prev;
+
+  if (!out.Close())
+    LogError("\n # Error writing animation file: %s\n", ctx->animFile.c_str());
+
+  // The arrays are declared before the objects using them
+  WriteString("#include \"");
+  WriteString(filesystem::path(ctx->animFile).filename().string().c_str());
+  WriteString("\"\n\n");
+
+  LogInfo("\n # Animation: %zu frames, %zu of %zu objects with tracks animated\n", frames, animated, nodes.size());
+}
+
+// loads the scene with name <fn> and if cache exist saves it as <fnback>
+static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
+{
+  if (!fn)
+    return false;
 
   // alloc C4D document and file
   AlienBaseDocument *C4Ddoc = NewObj(AlienBaseDocument);
@@ -1702,13 +2477,13 @@ static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
   // set a callback function for load progress
   //C4Dfile->SetLoadStatusCallback(myLoadProgressFunction,nullptr);
 
-  printf("\n # Dokument #\n");
-  printf(" - File: \"%s\"", fn);
+  LogInfo("\n # Dokument #\n");
+  LogInfo(" - File: \"%s\"", fn);
 
   // check if the file exists
   if (!GeFExist(fn))
   {
-    printf("\n   file is not existing\n   aborting...");
+    LogError("\n   file is not existing\n   aborting...");
 
     DeleteObj(C4Ddoc);
     DeleteObj(C4Dfile);
@@ -1718,14 +2493,14 @@ static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
 
   LocalFileTime mt;
   if (GeGetFileTime(Filename(fn), GE_FILETIME_CREATED, &mt))
-    printf("\n   + created    : %02d/%02d/%d", mt.month, mt.day, mt.year);
+    LogInfo("\n   + created    : %02d/%02d/%d", mt.month, mt.day, mt.year);
   if (GeGetFileTime(Filename(fn), GE_FILETIME_MODIFIED, &mt))
-    printf("\n   + modified   : %02d/%02d/%d", mt.month, mt.day, mt.year);
+    LogInfo("\n   + modified   : %02d/%02d/%d", mt.month, mt.day, mt.year);
 
   // do we know the file type ?
   if (GeIdentifyFile(fn) != IDENTIFYFILE_SCENE)
   {
-    printf("\n   + identified : unknown file type\n   aborting...");
+    LogError("\n   + identified : unknown file type\n   aborting...");
 
     DeleteObj(C4Ddoc);
     DeleteObj(C4Dfile);
@@ -1733,7 +2508,7 @@ static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
     return false;
   }
   else
-    printf("\n   + identified : Cinema4D Project File\n");
+    LogInfo("\n   + identified : Cinema4D Project File\n");
 
   // open the file for read
   // If you do not need file informations you can just use LoadDocument() without the need of a hyperfile !
@@ -1741,17 +2516,25 @@ static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
   {
     // read all chunks
     if (C4Ddoc->ReadObject(C4Dfile, true))
-      printf("\n   Read scene: SUCCEEDED (%d/%d bytes - fileversion: %d)\n", (int)C4Dfile->GetPosition(),(int)C4Dfile->GetLength(),(int)C4Dfile->GetFileVersion());
+      LogInfo("\n   Read scene: SUCCEEDED (%d/%d bytes - fileversion: %d)\n", (int)C4Dfile->GetPosition(),(int)C4Dfile->GetLength(),(int)C4Dfile->GetFileVersion());
     else
-      printf("\n   Read scene: FAILED (Error:%d) (%d/%d bytes - fileversion: %d)\n",(int)C4Dfile->GetError(), (int)C4Dfile->GetPosition(),(int)C4Dfile->GetLength(),(int)C4Dfile->GetFileVersion());
+    {
+      // A partly read scene must not be exported, cached or reported as done
+      LogError("\n   Read scene: FAILED (Error:%d) (%d/%d bytes - fileversion: %d)\n",(int)C4Dfile->GetError(), (int)C4Dfile->GetPosition(),(int)C4Dfile->GetLength(),(int)C4Dfile->GetFileVersion());
+      C4Dfile->Close();
+      DeleteObj(C4Ddoc);
+      DeleteObj(C4Dfile);
+
+      return false;
+    }
   }
   else
   {
     // failed to open
     if (C4Dfile->GetError() == FILEERROR_WRONG_VALUE)
-      printf("\n   Read scene: FAILED (Error:%d)- unknown filetype or version:\n               \"%s\"\n", (int)C4Dfile->GetError(), fn);
+      LogError("\n   Read scene: FAILED (Error:%d)- unknown filetype or version:\n               \"%s\"\n", (int)C4Dfile->GetError(), fn);
     else
-      printf("\n   Read scene: FAILED (Error:%d)- Could not open file \"%s\"\n", (int)C4Dfile->GetError(), fn);
+      LogError("\n   Read scene: FAILED (Error:%d)- Could not open file \"%s\"\n", (int)C4Dfile->GetError(), fn);
 
     DeleteObj(C4Ddoc);
     DeleteObj(C4Dfile);
@@ -1767,12 +2550,23 @@ static Bool LoadSaveC4DScene(const char *fn, const char *fnback)
 
   // checks for existing polygon caches (the option you can find in cinema Preferences->File->Option "Save Poylgons for Cineware")
   if (C4Ddoc->HasCaches())
-    printf("   Has caches: true\n");
+    LogTrace("   Has caches: true\n");
   else
-    printf("   Has caches: false\n");
+    LogTrace("   Has caches: false\n");
 
-  // calls all Execute() functions of the document (and prints scene information which is for demonstration purposes only)
+  // calls all Execute() functions of the document, which collect the exported objects into the scene IR
+  Scene& scene = g_export->scene;
   C4Ddoc->CreateSceneFromC4D();
+  LogInfo("\n # Scene: %d objects\n", (int)scene.Count());
+
+  // write SDL while the document is alive, IR payloads refer to its data
+  if (g_export->animation)
+    SampleAnimation(C4Ddoc, scene);
+  GroupScene(scene);
+  if (g_bounds)
+    BoundScene(scene);
+  EmitScene(scene);
+  scene.Clear();
 
   // if we have a fnback name save the file
   if (fnback)
@@ -2209,19 +3003,19 @@ Bool AlienBaseDocument::Execute()
 {
   // print document informations creator name, write name, author, copyright text, date created and saved
   Char *s = m_bc.GetString(DOCUMENT_INFO_PRGCREATOR_NAME).GetCStringCopy();
-  printf(" - Creator (Program): %s %d\n",(s?s:""),(int)m_bc.GetInt32(DOCUMENT_INFO_PRGCREATOR_ID));
+  LogTrace(" - Creator (Program): %s %d\n",(s?s:""),(int)m_bc.GetInt32(DOCUMENT_INFO_PRGCREATOR_ID));
   DeleteMem(s);
 
   s = m_bc.GetString(DOCUMENT_INFO_PRGWRITER_NAME).GetCStringCopy();
-  printf("   Writer  (Program): %s %d\n",(s?s:""),(int)m_bc.GetInt32(DOCUMENT_INFO_PRGWRITER_ID));
+  LogTrace("   Writer  (Program): %s %d\n",(s?s:""),(int)m_bc.GetInt32(DOCUMENT_INFO_PRGWRITER_ID));
   DeleteMem(s);
 
   s = m_bc.GetString(DOCUMENT_INFO_AUTHOR).GetCStringCopy();
-  printf("   Author           : %s\n",(s?s:""));
+  LogTrace("   Author           : %s\n",(s?s:""));
   DeleteMem(s);
 
   s = m_bc.GetString(DOCUMENT_INFO_COPYRIGHT).GetCStringCopy();
-  printf("   Copyright        : %s\n",(s?s:""));
+  LogTrace("   Copyright        : %s\n",(s?s:""));
   DeleteMem(s);
 
   Int64 _datecreated = m_bc.GetInt64(DOCUMENT_INFO_DATECREATED);
@@ -2238,7 +3032,7 @@ Bool AlienBaseDocument::Execute()
       }
     }
   }
-  printf("   Date Created     : %s\n",(s?s:""));
+  LogTrace("   Date Created     : %s\n",(s?s:""));
   DeleteMem(s);
 
   _datecreated = m_bc.GetInt64(DOCUMENT_INFO_DATESAVED);
@@ -2255,7 +3049,7 @@ Bool AlienBaseDocument::Execute()
       }
     }
   }
-  printf("   Date Saved       : %s\n",(s?s:""));
+  LogTrace("   Date Saved       : %s\n",(s?s:""));
   DeleteMem(s);
 
   // getting unit and scale
@@ -2266,7 +3060,7 @@ Bool AlienBaseDocument::Execute()
     DOCUMENT_UNIT docUnit;
     Float docScale;
     ud->GetUnitScale(docScale, docUnit);
-    printf(" - Unitscale: %f / %d\n", docScale, docUnit);
+    LogTrace(" - Unitscale: %f / %d\n", docScale, docUnit);
   }
 
   // print render data information
@@ -2288,7 +3082,14 @@ Bool AlienBaseDocument::Execute()
   // calculate frames
   start_frame = start_time  * fps;
   end_frame    = end_time    * fps;
-  printf(" - FPS: %d / %d - %d\n", (int)fps, (int)start_frame, (int)end_frame);
+  LogTrace(" - FPS: %d / %d - %d\n", (int)fps, (int)start_frame, (int)end_frame);
+
+  if (g_export)
+  {
+    g_export->fps = fps;
+    g_export->firstFrame = start_frame;
+    g_export->lastFrame = end_frame;
+  }
 
   return true;
 }
@@ -2299,11 +3100,11 @@ Bool AlienDeformerObjectData::Execute()
   Char *pChar = GetNode()->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienDeformerObjectData (%s): \"%s\"\n", GetObjectTypeName(GetDeformerType()), pChar);
+    LogTrace("\n - AlienDeformerObjectData (%s): \"%s\"\n", GetObjectTypeName(GetDeformerType()), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienDeformerObjectData (%s): <noname>\n", GetObjectTypeName(GetDeformerType()));
+    LogTrace("\n - AlienDeformerObjectData (%s): <noname>\n", GetObjectTypeName(GetDeformerType()));
 
   PrintUniqueIDs(this);
 
@@ -2317,11 +3118,11 @@ Bool AlienFFDObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienFFDObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienFFDObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienFFDObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienFFDObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2333,27 +3134,15 @@ Bool AlienFFDObjectData::Execute()
 //
 Bool AlienNullObjectData::Execute()
 {
-  printf("----------------- NULL: EXPORT START ------------------");
+  LogTrace("----------------- NULL: EXPORT START ------------------");
   BaseObject* op = (BaseObject*)GetNode();
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienNullObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
-  }
-  else
-    printf("\n - AlienNullObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienNullObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^-------------- NULL: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^---------------- NULL: Already exported -----------------^\n");
+    LogTrace("\n^-------------- NULL: Not exported - Render off ------^\n");
     return true;
   }
 
@@ -2362,41 +3151,23 @@ Bool AlienNullObjectData::Execute()
   PrintMatrix(m);
   PrintTagInfo(op);
 
-  // Write header
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
-  {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
-  }
-
-  fprintf(file, "%sunion {\n\n", declare);
-
-  // Children
-  BaseObject* ch = op->GetDown();
-  while (ch != NULL)
-  {
-    Char* chName = ch->GetName().GetCStringCopy();
-    printf("\n   - Child - AlienNullObjectData (%d): %s\n", (int)ch->GetType(), chName);
-    DeleteMem(chName);
-    ch->Execute();
-    ch = ch->GetNext();
-  }
+  AddNode(NODE_NULL, op, objName, this, true);
 
-  if (!at_root)
-  {
-    WriteMatrix(op);
-    WriteMaterial(op);
-  }
+  LogTrace("^---------------- NULL: EXPORT END -------------------^\n");
+  return true;
+}
 
-  // Close object  
-  fprintf(file, "}\n\n");
+void AlienNullObjectData::Emit(SceneNode* node)
+{
+  WriteDeclare(node);
+  WriteString("union {\n\n");
+  EmitChildren(node);
+  WriteClose(node);
+}
 
-  DeleteMem(objName);
-  exported = true;
-  printf("^---------------- NULL: EXPORT END -------------------^\n");
-  return true;
+bool AlienNullObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  return ChildBounds(node, "union", bounds);
 }
 
 // Execute function for the self defined Foreground object
@@ -2406,11 +3177,11 @@ Bool AlienForegroundObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienForegroundObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienForegroundObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienForegroundObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienForegroundObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2424,11 +3195,11 @@ Bool AlienBackgroundObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienBackgroundObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienBackgroundObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienBackgroundObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienBackgroundObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2442,11 +3213,11 @@ Bool AlienFloorObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienFloorObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienFloorObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienFloorObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienFloorObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2460,11 +3231,11 @@ Bool AlienSkyObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienSkyObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienSkyObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienSkyObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienSkyObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2478,11 +3249,11 @@ Bool AlienSkyShaderObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienSkyShaderObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienSkyShaderObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienSkyShaderObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienSkyShaderObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2496,11 +3267,11 @@ Bool AlienCAJointObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienCAJointObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienCAJointObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienCAJointObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienCAJointObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2514,11 +3285,11 @@ Bool AlienCASkinObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienCASkinObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienCASkinObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienCASkinObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienCASkinObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2532,11 +3303,11 @@ Bool AlienCAMeshDeformerObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienCAMeshDeformerObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienCAMeshDeformerObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienCAMeshDeformerObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienCAMeshDeformerObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -2546,7 +3317,7 @@ Bool AlienCAMeshDeformerObjectData::Execute()
     Char* str = memUsage.GetString().GetCStringCopy();
     if (str)
     {
-      printf("\n     Memory Usage in Bytes : (%s)\n", str);
+      LogTrace("\n     Memory Usage in Bytes : (%s)\n", str);
       DeleteMem(str);
     }
   }
@@ -2560,20 +3331,20 @@ Bool AlienEnvironmentObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienEnvironmentObjectData (%d): \"%s\"", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienEnvironmentObjectData (%d): \"%s\"", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienEnvironmentObjectData (%d): <noname>", (int)op->GetType());
+    LogTrace("\n - AlienEnvironmentObjectData (%d): <noname>", (int)op->GetType());
 
   GeData data;
   Vector col = Vector(0.0, 0.0, 0.0);
   if (op->GetParameter(ENVIRONMENT_AMBIENT, data))
   {
     col = data.GetVector();
-    printf(" - Color: %d / %d / %d", (int)(col.x*255),(int)(col.y*255),(int)(col.z*255));
+    LogTrace(" - Color: %d / %d / %d", (int)(col.x*255),(int)(col.y*255),(int)(col.z*255));
   }
-  printf("\n");
+  LogTrace("\n");
 
   PrintUniqueIDs(this);
 
@@ -2585,37 +3356,26 @@ Bool AlienEnvironmentObjectData::Execute()
 //
 Bool AlienBoolObjectData::Execute()
 {
-  printf("\n----------------- BOOL: EXPORT START ------------------\n");
+  LogTrace("\n----------------- BOOL: EXPORT START ------------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^-------------- BOOL: Not exported - Disabled --------^\n");
+      LogTrace("\n^-------------- BOOL: Not exported - Disabled --------^\n");
+      AddNode(NODE_BOOL, op, ObjectName(op), nullptr, false);  // keeps children in place
       return true;
     }
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^-------------- BOOL: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^---------------- BOOL: Already exported -----------------^\n");
+    LogTrace("\n^-------------- BOOL: Not exported - Render off ------^\n");
     return true;
   }
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienBoolObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
-  }
-  else
-    printf("\n - AlienBoolObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienBoolObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
 
   PrintUniqueIDs(this);
 
@@ -2623,10 +3383,10 @@ Bool AlienBoolObjectData::Execute()
   if (op->GetParameter(BOOLEOBJECT_TYPE, data))
   {
     boolType = data.GetInt32();
-    printf(" - Boolean Type: %d\n", (int)boolType);
+    LogTrace(" - Boolean Type: %d\n", (int)boolType);
   }
 
-  string boolTypeStr = "";
+  const char* boolTypeStr;
   switch (boolType)
   {
     case BOOLEOBJECT_TYPE_UNION:     boolTypeStr = "union";        break;
@@ -2636,90 +3396,184 @@ Bool AlienBoolObjectData::Execute()
     default: boolTypeStr = "union";
   }
 
-  // Write header 
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
+  SceneNode* node = AddNode(NODE_BOOL, op, objName, this, true);
+  node->payload = (void*)boolTypeStr;
+  HashNode(node, boolTypeStr);
+
+  LogTrace("\n^--------------- BOOL: EXPORT END ------------------^\n");
+  return true;
+}
+
+void AlienBoolObjectData::Emit(SceneNode* node)
+{
+  WriteDeclare(node);
+  WriteString((const char*)node->payload);
+  WriteString(" {\n\n");
+  EmitChildren(node);
+  WriteClose(node);
+}
+
+bool AlienBoolObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  return ChildBounds(node, (const char*)node->payload, bounds);
+}
+
+//
+// Point of spline segment 'seg' (from point seg to the next one) at u in
+// [0, 1]. Bezier segments use the tangents, cubic and Akima splines are
+// approximated by Catmull-Rom curves, B-splines are uniform cubic ones.
+//
+static CurvePoint SplinePoint(Int32 spType, const Vector* p, const Tangent* t, Int32 pc, bool closed, size_t seg, double u)
+{
+  auto at = [&](Int32 i) { return ToCurvePoint(p[closed ? (i % pc + pc) % pc : max(0, min(i, pc - 1))]); };
+  Int32 i = (Int32)seg;
+  CurvePoint q[4] = { at(i - 1), at(i), at(i + 1), at(i + 2) };
+  double v = 1.0 - u;
+  double w[4];
+  if (spType == SPLINEOBJECT_TYPE_BEZIER && t)
+  {
+    Int32 j = (i + 1) % pc;
+    q[0] = q[1];
+    q[1] = ToCurvePoint(p[i] + t[i].vr);
+    q[2] = ToCurvePoint(p[j] + t[j].vl);
+    q[3] = ToCurvePoint(p[j]);
+    w[0] = v * v * v;
+    w[1] = 3 * u * v * v;
+    w[2] = 3 * u * u * v;
+    w[3] = u * u * u;
+  }
+  else if (spType == SPLINEOBJECT_TYPE_BSPLINE)
+  {
+    w[0] = v * v * v / 6;
+    w[1] = (3 * u * u * u - 6 * u * u + 4) / 6;
+    w[2] = (-3 * u * u * u + 3 * u * u + 3 * u + 1) / 6;
+    w[3] = u * u * u / 6;
+  }
+  else
   {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
+    w[0] = (-u * u * u + 2 * u * u - u) / 2;
+    w[1] = (3 * u * u * u - 5 * u * u + 2) / 2;
+    w[2] = (-3 * u * u * u + 4 * u * u + u) / 2;
+    w[3] = (u * u * u - u * u) / 2;
   }
- 
-  fprintf(file, "%s%s {\n\n", declare, boolTypeStr.c_str());
 
-  // Children
-  BaseObject* ch = op->GetDown();
-  while (ch != NULL)
+  CurvePoint r = { 0, 0, 0 };
+  for (int k = 0; k < 4; k++)
   {
-    Char* chName = ch->GetName().GetCStringCopy();
-    printf("\n   - Child - AlienBoolObjectData (%d): %s\n", (int)ch->GetType(), chName);
-    DeleteMem(chName);
-    ch->Execute();
-    ch = ch->GetNext();
+    r.x += w[k] * q[k].x;
+    r.y += w[k] * q[k].y;
+    r.z += w[k] * q[k].z;
   }
+  return r;
+}
+
+//
+// Spline points with --spline-tolerance: curves written as raw control
+// points ('native' false for their type) become adaptive polylines,
+// linear splines are simplified. The angle limit is the spline's own
+// adaptive angle, or 5 degrees. Returns false if nothing changed.
+//
+static bool ResampleSpline(SplineObject* sp, bool native, Int32& spType, Int32& pc, const Vector*& p, const Tangent*& t)
+{
+  if (g_splineTolerance <= 0.0 || pc < 3 || !p || sp->GetSegmentCount() > 1)
+    return false;
 
-  if(!at_root)
+  bool closed = sp->GetIsClosed();
+  vector<CurvePoint> out;
+  if (spType != SPLINEOBJECT_TYPE_LINEAR)
   {
-    WriteMatrix(op);
-    WriteMaterial(op);
+    if (native)
+      return false;
+
+    double angle = 5.0 * PI / 180.0;
+    GeData data;
+    if (sp->GetParameter(SPLINEOBJECT_INTERPOLATION, data) &&
+        (data.GetInt32() == SPLINEOBJECT_INTERPOLATION_ADAPTIVE || data.GetInt32() == SPLINEOBJECT_INTERPOLATION_SUBDIV) &&
+        sp->GetParameter(SPLINEOBJECT_ANGLE, data) && data.GetFloat() > 0.0)
+      angle = data.GetFloat();
+
+    auto eval = [&](size_t seg, double u) { return SplinePoint(spType, p, t, pc, closed, seg, u); };
+    ResampleCurve(eval, closed ? pc : pc - 1, g_splineTolerance, angle, !closed, out);
+    spType = SPLINEOBJECT_TYPE_LINEAR;
+  }
+  else
+  {
+    vector<size_t> keep;
+    SimplifyPolyline(p, pc, g_splineTolerance, keep, closed);
+    if (keep.size() == (size_t)pc)
+      return false;
+    for (size_t i : keep)
+      out.push_back(ToCurvePoint(p[i]));
   }
 
-  // Close object  
-  fprintf(file, "}\n\n");
-  
-  DeleteMem(objName);
-  exported = true;
-  printf("\n^--------------- BOOL: EXPORT END ------------------^\n");
+  Vector* points = g_export->scene.arena.NewArray<Vector>(out.size());
+  for (size_t i = 0; i < out.size(); i++)
+    points[i] = Vector(out[i].x, out[i].y, out[i].z);
+
+  LogTrace("   - Spline resampled: %d -> %d points\n", (int)pc, (int)out.size());
+  pc = (Int32)out.size();
+  p = points;
+  t = nullptr;
   return true;
 }
 
+//
+// Box of a curve through the written control points 'w'
+//
+static void CurveBounds(CurveBasis basis, const vector<CurvePoint>& w, Bounds& b)
+{
+  CurveRange(basis, w.size(), [&](size_t i) { return w[i].x; }, b.lo[0], b.hi[0]);
+  CurveRange(basis, w.size(), [&](size_t i) { return w[i].y; }, b.lo[1], b.hi[1]);
+  CurveRange(basis, w.size(), [&](size_t i) { return w[i].z; }, b.lo[2], b.hi[2]);
+}
+
 // 
 // Extrude
 //
+struct ExtrudePayload
+{
+  Float height;
+  Int32 spType;
+  Int32 pc;
+  const Vector* p;    // points and tangents of child spline
+  const Tangent* t;
+  Int32 sc;           // number of spline segments, sub-paths of the prism
+  const Int32* cnt;   // points per segment
+};
+
 Bool AlienExtrudeObjectData::Execute()
 {
-  printf("--------------- EXTRUDE: EXPORT START -----------------\n");
+  LogTrace("--------------- EXTRUDE: EXPORT START -----------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^----------- EXTRUDE: Not exported - Disabled --------^\n");
+      LogTrace("\n^----------- EXTRUDE: Not exported - Disabled --------^\n");
+      AddNode(NODE_EXTRUDE, op, ObjectName(op), nullptr, false);  // keeps children in place
       return true;
     }
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^----------- EXTRUDE: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^--------------- EXTRUDE: Already exported -----------^\n, objName");
+    LogTrace("\n^----------- EXTRUDE: Not exported - Render off ------^\n");
     return true;
   }
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienExtrudeObjectData (%d): %s\n", (int)op->GetType(), objName);
-  }
-  else
-    printf("\n - AlienExtrudeObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienExtrudeObjectData (%d): %s\n", (int)op->GetType(), objName);
 
   // Params
   Vector movement = Vector(0.0, 0.0, 0.0);
   if (op->GetParameter(EXTRUDEOBJECT_MOVE, data))
     movement = data.GetVector();
-  printf("\n   - GetMovement(): %.2f / %.2f / %.2f \n", movement.x, movement.y, movement.z);
+  LogTrace("\n   - GetMovement(): %.2f / %.2f / %.2f \n", movement.x, movement.y, movement.z);
 
   Int32 endSteps = 0;
   if (op->GetParameter(CAP_ENDSTEPS, data))
     endSteps = data.GetInt32();
-  printf("   - GetEndCapSteps(): %d \n", (int)endSteps);
+  LogTrace("   - GetEndCapSteps(): %d \n", (int)endSteps);
 
   PrintUniqueIDs(this);
 
@@ -2727,163 +3581,297 @@ Bool AlienExtrudeObjectData::Execute()
   AlienSplineObject* ch1 = (AlienSplineObject*)op->GetDown();
   if (!ch1)
   {
-    printf("\n^--------------- EXTRUDE: NOT EXPORTED - NO CHILD ----^\n");
-    DeleteMem(objName);
+    LogWarn("\n^--------------- EXTRUDE: '%s' NOT EXPORTED - NO CHILD ----^\n", objName);
     return true;
   }
 
   Char* ch1n = ch1->GetName().GetCStringCopy();
   if (ch1n)
   {
-    printf("\n   - Child_1: type='%d', name='%s'\n", (int)ch1->GetType(), ch1n);
+    LogTrace("\n   - Child_1: type='%d', name='%s'\n", (int)ch1->GetType(), ch1n);
     DeleteMem(ch1n);
   }
 
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
-  {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
-  }
-
-  float height = movement.y;
+  ExtrudePayload* ex = g_export->scene.arena.New<ExtrudePayload>();
+  ex->height = movement.y;
 
   // Spline type
-  Int32 spType = -1;
+  ex->spType = -1;
   if (ch1->GetParameter(SPLINEOBJECT_TYPE, data))
-    spType = data.GetInt32();
+    ex->spType = data.GetInt32();
 
   // Points
-  int pc = ch1->GetPointCount();
-  const Vector* p = ch1->GetPointR();
+  ex->pc = ch1->GetPointCount();
+  ex->p = ch1->GetPointR();
+  ex->t = ch1->GetTangentR();
+  bool native = ex->spType == SPLINEOBJECT_TYPE_CUBIC || ex->spType == SPLINEOBJECT_TYPE_BEZIER;
+  ResampleSpline(ch1, native, ex->spType, ex->pc, ex->p, ex->t);
+
+  // Segments: contours and holes of letters, gaskets...
+  Int32 sc = ch1->GetSegmentCount();
+  const Segment* seg = ch1->GetSegmentR();
+  Int32* cnt = g_export->scene.arena.NewArray<Int32>(sc > 0 ? sc : 1);
+  Int32 sum = 0;
+  for (Int32 i = 0; seg && i < sc; i++)
+    sum += cnt[i] = seg[i].cnt;
+  if (sc <= 0 || !seg || sum != ex->pc)
+  {
+    sc = 1;
+    cnt[0] = ex->pc;
+  }
+  ex->sc = sc;
+  ex->cnt = cnt;
+  LogTrace("   - Prism sub-paths: %d\n", (int)sc);
+
+  SceneNode* node = AddNode(NODE_EXTRUDE, op, objName, this, true);
+  node->payload = ex;
+  HashValues(node, ex->height, ex->spType, ex->pc, ex->sc);
+  HashNode(node, ex->cnt, ex->sc * sizeof(Int32));
+  HashNode(node, ex->p, ex->pc * sizeof(Vector));
+  if (ex->t)
+    HashNode(node, ex->t, ex->pc * sizeof(Tangent));
+
+  LogTrace("^-------------- EXTRUDE: EXPORT END ------------------^\n");
+  return true;
+}
 
-  int tc = ch1->GetTangentCount();
-  const Tangent* t = ch1->GetTangentR();
-  
+//
+// Closed prism sub-path of points 'p', tangents 't': point(x, z) for
+// every written point
+//
+template <class F>
+static void PrismPath(Int32 spType, Int32 pc, const Vector* p, const Tangent* t, F point)
+{
   if (spType == SPLINEOBJECT_TYPE_CUBIC)
   {
-    // CUBIC spline
-    fprintf(file, "%sprism { linear_sweep cubic_spline 0, %lf, %d\n\n", declare, height, pc + 3);
-
-    fprintf(file, "  <%f, %f>\n", p[pc - 1].x, p[pc - 1].z);  // Control 1
+    point(p[pc - 1].x, p[pc - 1].z);  // Control 1
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].z);
+      point(p[i].x, p[i].z);
     }
-    fprintf(file, "  <%f, %f>\n", p[0].x, p[0].z); // Close
-    fprintf(file, "  <%f, %f>\n", p[1].x, p[1].z);  // Control 2
+    point(p[0].x, p[0].z); // Close
+    point(p[1].x, p[1].z);  // Control 2
 
   } else if (spType == SPLINEOBJECT_TYPE_BEZIER)
   {
-    // Write
-    fprintf(file, "%sprism { linear_sweep bezier_spline 0, %lf, %d\n\n", declare, height, pc * 4);
     pc--;
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].z); // Point 1
-      fprintf(file, "  <%f, %f>\n", t[i].vr.x + p[i].x, t[i].vr.z + p[i].z); // Tangent 1
-      fprintf(file, "  <%f, %f>\n", t[i + 1].vl.x + p[i + 1].x, t[i + 1].vl.z + p[i + 1].z); // Tangent 2
-      fprintf(file, "  <%f, %f>\n", p[i + 1].x, p[i + 1].z); // Point 2
+      point(p[i].x, p[i].z); // Point 1
+      point(t[i].vr.x + p[i].x, t[i].vr.z + p[i].z); // Tangent 1
+      point(t[i + 1].vl.x + p[i + 1].x, t[i + 1].vl.z + p[i + 1].z); // Tangent 2
+      point(p[i + 1].x, p[i + 1].z); // Point 2
     }
 
-    fprintf(file, "  <%f, %f>\n", p[pc].x, p[pc].z); // Close
-    fprintf(file, "  <%f, %f>\n", t[pc].vr.x + p[pc].x, t[pc].vr.z + p[pc].z); // Tangent 1
-    fprintf(file, "  <%f, %f>\n", t[0].vl.x + p[0].x, t[0].vl.z + p[0].z);     // Tangent 2
-    fprintf(file, "  <%f, %f>\n", p[0].x, p[0].z);
+    point(p[pc].x, p[pc].z); // Close
+    point(t[pc].vr.x + p[pc].x, t[pc].vr.z + p[pc].z); // Tangent 1
+    point(t[0].vl.x + p[0].x, t[0].vl.z + p[0].z);     // Tangent 2
+    point(p[0].x, p[0].z);
 
   }  else
   {
-    // LINEAR spline 
-    fprintf(file, "%sprism { linear_sweep linear_spline 0, %lf, %d\n\n", declare, height, pc + 1);
-
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].z);
+      point(p[i].x, p[i].z);
     }
-    fprintf(file, "  <%f, %f>\n", p[0].x, p[0].z); // Close spline
-    fprintf(file, "\n");
+    point(p[0].x, p[0].z); // Close spline
   }
+}
+
+//
+// One prism for all segments of the spline: each segment is a closed
+// sub-path, POV-Ray fills them even-odd, so inner contours are holes
+//
+void AlienExtrudeObjectData::Emit(SceneNode* node)
+{
+  const ExtrudePayload* ex = (const ExtrudePayload*)node->payload;
+  bool bezier = ex->spType == SPLINEOBJECT_TYPE_BEZIER && ex->t;
+  Int32 spType = bezier || ex->spType == SPLINEOBJECT_TYPE_CUBIC ? ex->spType : SPLINEOBJECT_TYPE_LINEAR;
 
-  ch1->SetExported();
-  if(!at_root)
+  // Segments too short for a contour are left out
+  int count = 0;
+  for (Int32 s = 0; s < ex->sc; s++)
   {
-    WriteMatrix(op);
-    WriteMaterial(op);
+    Int32 n = ex->cnt[s];
+    if (n >= 2)
+      count += spType == SPLINEOBJECT_TYPE_CUBIC ? n + 3 : (bezier ? n * 4 : n + 1);
   }
 
-  // Close object  
-  fprintf(file, "}\n\n");
+  WriteDeclare(node);
+  WriteString(spType == SPLINEOBJECT_TYPE_CUBIC ? "prism { linear_sweep cubic_spline 0, " :
+              bezier ? "prism { linear_sweep bezier_spline 0, " : "prism { linear_sweep linear_spline 0, ");
+  WriteFloat(ex->height);
+  WriteString(", ");
+  WriteInt(count);
+  WriteString("\n\n");
+
+  Int32 first = 0;
+  for (Int32 s = 0; s < ex->sc; s++)
+  {
+    Int32 n = ex->cnt[s];
+    if (n >= 2)
+      PrismPath(spType, n, ex->p + first, bezier ? ex->t + first : nullptr, WritePoint2);
+    first += n;
+  }
+  if (spType == SPLINEOBJECT_TYPE_LINEAR)
+    WriteString("\n");
 
-  printf("^-------------- EXTRUDE: EXPORT END ------------------^\n", objName);
-  exported = true;
+  WriteClose(node);
+}
 
-  DeleteMem(objName);
+bool AlienExtrudeObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  const ExtrudePayload* ex = (const ExtrudePayload*)node->payload;
+  bool bezier = ex->spType == SPLINEOBJECT_TYPE_BEZIER && ex->t;
+  Int32 spType = bezier || ex->spType == SPLINEOBJECT_TYPE_CUBIC ? ex->spType : SPLINEOBJECT_TYPE_LINEAR;
+  CurveBasis basis = spType == SPLINEOBJECT_TYPE_CUBIC ? CURVE_CATMULL_ROM : (bezier ? CURVE_BEZIER : CURVE_LINEAR);
+
+  // Outline in the xz plane, swept from 0 to the height
+  vector<CurvePoint> w;
+  Int32 first = 0;
+  for (Int32 s = 0; s < ex->sc; s++)
+  {
+    Int32 n = ex->cnt[s];
+    if (n >= 2)
+    {
+      w.clear();
+      PrismPath(spType, n, ex->p + first, bezier ? ex->t + first : nullptr, [&](double x, double z) { w.push_back({ x, 0.0, z }); });
+      CurveBounds(basis, w, bounds);
+    }
+    first += n;
+  }
+  bounds.lo[1] = min(0.0, ex->height);
+  bounds.hi[1] = max(0.0, ex->height);
   return true;
 }
 
+//
+// Write sphere_sweep point: "  <x, y, z>, r<end>"
+//
+static void WriteSweepPoint(const Vector& v, double r, const char* end)
+{
+  char* p = sink->Reserve(MAX_VECTOR_CHARS + MAX_NUMBER_CHARS + 8);
+  *p++ = ' ';
+  *p++ = ' ';
+  p = FormatVec3(p, v.x, v.y, v.z, g_floatFormat);
+  *p++ = ',';
+  *p++ = ' ';
+  p = FormatFloat(p, r, g_floatFormat);
+  sink->Commit(p);
+  WriteString(end);
+}
+
 // 
 // Sweep
 //
+
+//
+// Sweep radii at arc length fractions of the path. With a tolerance,
+// points are inserted between path points until the linear radius
+// interpolation of the written segments is within the tolerance.
+//
+struct SweepRadius
+{
+  tk::spline& profile;
+  double radius;
+  double endScale;
+  double tolerance;
+  vector<Vector> points;
+  vector<double> radii;
+
+  static const int MAX_DEPTH = 8;   // at most 255 points per segment
+
+  double At(double t)
+  {
+    double pscale = min(profile(t), 1.0);
+    return radius * (1.0 + (endScale - 1.0) * t) * pscale;
+  }
+
+  void Add(const Vector& v, double r)
+  {
+    points.push_back(v);
+    radii.push_back(r);
+  }
+
+  // Points between a and b, without b
+  void Segment(const Vector& a, const Vector& b, double ta, double tb, double ra, double rb, int depth)
+  {
+    double err = 0.0;
+    if (tolerance > 0.0 && depth < MAX_DEPTH)
+      for (double f : { 0.25, 0.5, 0.75 })
+        err = max(err, fabs(At(ta + f * (tb - ta)) - (ra + f * (rb - ra))));
+
+    if (err <= tolerance)
+    {
+      Add(a, ra);
+      return;
+    }
+
+    double tm = 0.5 * (ta + tb);
+    double rm = At(tm);
+    Vector m = (a + b) * 0.5;
+    Segment(a, m, ta, tm, ra, rm, depth + 1);
+    Segment(m, b, tm, tb, rm, rb, depth + 1);
+  }
+};
+
+struct SweepPayload
+{
+  const char* spTypeStr;
+  Int32 spType;
+  Int32 pc;
+  Int32 pn;           // number of written points
+  bool closed;
+  const Vector* p;    // path points
+  double r0;          // radius of first control point
+  double r1;          // radius of closing point
+  double* r;          // radius at path points
+};
+
 Bool AlienSweepObjectData::Execute()
 {
-  printf("---------------- SWEEP: EXPORT START ------------------\n");
+  LogTrace("---------------- SWEEP: EXPORT START ------------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^------------- SWEEP: Not exported - Disabled --------^\n");
+      LogTrace("\n^------------- SWEEP: Not exported - Disabled --------^\n");
+      AddNode(NODE_SWEEP, op, ObjectName(op), nullptr, false);  // keeps children in place
       return true;
     }
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^------------- SWEEP: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^--------------- SWEEP: Already exported -----------------^\n");
+    LogTrace("\n^------------- SWEEP: Not exported - Render off ------^\n");
     return true;
   }
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienSweepObjectData (%d): %s\n", (int)op->GetType(), objName);
-  }
-  else
-    printf("\n - AlienSweepObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienSweepObjectData (%d): %s\n", (int)op->GetType(), objName);
 
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
+  // Child 1 - profile
+  AlienSplineObject* ch1 = (AlienSplineObject*)op->GetDown();
+  if (!ch1)
   {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
+    LogWarn("\n^--------------- SWEEP: '%s' NOT EXPORTED - NO CHILD ------^\n", objName);
+    return true;
   }
 
-  DeleteMem(objName);
-
-  // Child 1 - profile
-  AlienSplineObject* ch1 = (AlienSplineObject*)op->GetDown();
   Char* pChar = ch1->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\nCh1 - AlienSweepObjectData (%d): %s\n", (int)ch1->GetType(), pChar);
+    LogTrace("\nCh1 - AlienSweepObjectData (%d): %s\n", (int)ch1->GetType(), pChar);
     DeleteMem(pChar);
   }
 
+  // Not exported nodes keep their child splines from export
   int ch1Type = ch1->GetType();
   if (ch1Type != Osplinecircle)
   {
-    printf("\n^------- SWEEP: cat't sweep object of type '%d' ----^\n", ch1Type);
-    ch1->SetExported();
-    exported = true;
+    LogWarn("\n^------- SWEEP: '%s' cat't sweep object of type '%d' ----^\n", objName, ch1Type);
+    AddNode(NODE_SWEEP, op, objName, nullptr, false);
     return true;
   }
 
@@ -2891,7 +3879,7 @@ Bool AlienSweepObjectData::Execute()
   if (ch1->GetParameter(PRIM_CIRCLE_RADIUS, data))
   {
     radius = data.GetFloat();
-    printf("\nCh1 - radius: %f\n", radius);
+    LogTrace("\nCh1 - radius: %f\n", radius);
   }
 
   // Child 2 - path
@@ -2900,16 +3888,15 @@ Bool AlienSweepObjectData::Execute()
   pChar = ch2->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\nCh2 - AlienSweepObjectData (%d): %s\n", (int)ch2->GetType(), pChar);
+    LogTrace("\nCh2 - AlienSweepObjectData (%d): %s\n", (int)ch2->GetType(), pChar);
     DeleteMem(pChar);
   }
 
   int ch2Type = ch2->GetType();
   if (ch2Type != Ospline)
   {
-    printf("\n^- SWEEP: cat't use object of type '%d' as path-----^\n", ch2Type);
-    ch2->SetExported();
-    exported = true;
+    LogWarn("\n^- SWEEP: '%s' cat't use object of type '%d' as path-----^\n", objName, ch2Type);
+    AddNode(NODE_SWEEP, op, objName, nullptr, false);
     return true;
   }
 
@@ -2917,18 +3904,15 @@ Bool AlienSweepObjectData::Execute()
   Int32 pc = ch2->GetPointCount();
   const Vector* p = ch2->GetPointR();
 
-  // End scale TODO: Interpolate on whole length
+  // End scale, reached at the end of the path
   Float scale = 1;
   if (op->GetParameter(SWEEPOBJECT_SCALE, data))
     scale = data.GetFloat();
-  Float scale_step = (scale - 1.0) / (Float)(pc - 1);
-  scale = 1;
 
   // Profile spline
   std::vector<double> prof_x;
   std::vector<double> prof_y;
   tk::spline profile;
-  Float p_step = (Float)1.0 / (Float)(pc - 1);
   CustomSplineKnotInterpolation interpol;
 
   op->GetParameter(SWEEPOBJECT_SPLINESCALE, data);
@@ -2940,7 +3924,7 @@ Bool AlienSweepObjectData::Execute()
     {
       // Knots
       Int32 kc = sd->GetKnotCount();
-      printf("\n  - Number of knots %d \n", (int)kc);
+      LogTrace("\n  - Number of knots %d \n", (int)kc);
 
       // First
       CustomSplineKnot* ke = sd->GetKnot(0);
@@ -2953,7 +3937,7 @@ Bool AlienSweepObjectData::Execute()
         CustomSplineKnot* k = sd->GetKnot(i);
         prof_x.push_back(k->vPos.x);
         prof_y.push_back(k->vPos.y);
-        printf("  - Knot %d: x=%f, y=%f\n", i, k->vPos.x, k->vPos.y);
+        LogTrace("  - Knot %d: x=%f, y=%f\n", i, k->vPos.x, k->vPos.y);
       }
 
       // Last
@@ -2975,8 +3959,12 @@ Bool AlienSweepObjectData::Execute()
   if (ch2->GetParameter(SPLINEOBJECT_TYPE, data))
     spType = data.GetInt32();
 
+  const Tangent* t = ch2->GetTangentR();
+  bool native = spType == SPLINEOBJECT_TYPE_CUBIC || spType == SPLINEOBJECT_TYPE_BSPLINE;
+  ResampleSpline(ch2, native, spType, pc, p, t);
+
   int pn = pc;
-  string spTypeStr = "linear_spline";
+  const char* spTypeStr = "linear_spline";
   switch (spType)
   {
     case SPLINEOBJECT_TYPE_LINEAR:  spTypeStr = "linear_spline" ; break;
@@ -2984,183 +3972,303 @@ Bool AlienSweepObjectData::Execute()
     case SPLINEOBJECT_TYPE_BSPLINE: spTypeStr = "b_spline"      ; pn += 2; break;
   }
   
-  // Wrire
-  Float r = 0;
+
+  // Radii at the arc length fractions of the path points. Points are
+  // only inserted into linear paths, they would change curved ones.
+  // Closed paths end at the closing point, back at the first one.
   bool closed = ch2->GetIsClosed();
-  if(closed)
-    pn++;
-  fprintf(file, "%ssphere_sweep  { %s %d\n\n", declare, spTypeStr.c_str(), pn);
+  vector<double> len;
+  ArcLengthTable(p, pc, len, closed);
+  double total = len.empty() ? 0.0 : len.back();
+  int segments = closed ? pc : pc - 1;
+  bool linear = spType != SPLINEOBJECT_TYPE_CUBIC && spType != SPLINEOBJECT_TYPE_BSPLINE;
+  SweepRadius radii = { profile, radius, scale, linear ? g_sweepTolerance : 0.0 };
+
+  auto fraction = [&](int i) { return total > 0.0 ? len[i] / total : (segments > 0 ? (double)i / segments : 0.0); };
+  for (int i = 0; i < segments; i++)
+    radii.Segment(p[i], p[(i + 1) % pc], fraction(i), fraction(i + 1), radii.At(fraction(i)), radii.At(fraction(i + 1)), 0);
+  if (pc > 0 && !closed)
+    radii.Add(p[pc - 1], radii.At(1.0));
+
+  Int32 added = (Int32)radii.points.size() - pc;
+  if (added > 0)
+    LogTrace("\n  - Sweep points inserted for radius tolerance: %d\n", (int)added);
+
+  SweepPayload* sw = g_export->scene.arena.New<SweepPayload>();
+  sw->spTypeStr = spTypeStr;
+  sw->spType = spType;
+  sw->pc = pc + added;
+  sw->closed = closed;
+  sw->pn = (sw->closed ? pn + 1 : pn) + added;
+  sw->r0 = radii.At(0.0);
+  sw->r1 = radii.At(1.0);
+  if (added > 0)
+  {
+    Vector* points = g_export->scene.arena.NewArray<Vector>(sw->pc);
+    copy(radii.points.begin(), radii.points.end(), points);
+    sw->p = points;
+  }
+  else
+    sw->p = p;
+  sw->r = g_export->scene.arena.NewArray<double>(sw->pc);
+  copy(radii.radii.begin(), radii.radii.end(), sw->r);
+
+  SceneNode* node = AddNode(NODE_SWEEP, op, objName, this, true);
+  node->payload = sw;
+  HashNode(node, sw->spTypeStr);
+  HashValues(node, sw->spType, sw->pc, sw->pn, sw->closed, sw->r0, sw->r1);
+  HashNode(node, sw->p, sw->pc * sizeof(Vector));
+  HashNode(node, sw->r, sw->pc * sizeof(double));
+
+  LogTrace("\n^---------------- SWEEP: EXPORT END ------------------^\n");
+  return true;
+}
 
-  double pscale = profile(0);
-  pscale > 1 ? pscale = 1 : pscale;
-  r = radius * scale * pscale;
+//
+// Sweep path: point(v, r, end) for every written point
+//
+template <class F>
+static void SweepPath(const SweepPayload* sw, F point)
+{
+  const Vector* p = sw->p;
+  Int32 pc = sw->pc;
+  bool controls = (sw->spType == SPLINEOBJECT_TYPE_CUBIC) || (sw->spType == SPLINEOBJECT_TYPE_BSPLINE);
 
   // Control 1  
-  if ((spType == SPLINEOBJECT_TYPE_CUBIC) || (spType == SPLINEOBJECT_TYPE_BSPLINE))
-    if (closed)
-      fprintf(file, "  <%f, %f, %f>, %f\n", p[pc - 1].x, p[pc - 1].y, p[pc - 1].z, r);
+  if (controls)
+  {
+    if (sw->closed)
+      point(p[pc - 1], sw->r0, "\n");
     else
-      fprintf(file, "  <%f, %f, %f>, %f,\n", p[0].x, p[0].y, p[0].z, r);
+      point(p[0], sw->r0, ",\n");
+  }
 
   for (int i = 0; i < pc; i++)
-  {
-    pscale = profile(i * p_step);
-    pscale > 1 ? pscale = 1 : pscale;
-    r = radius * scale * pscale;
-    scale += scale_step;
+    point(p[i], sw->r[i], ",\n");
 
-    fprintf(file, "  <%f, %f, %f>, %f,\n", p[i].x, p[i].y, p[i].z, r);
-  }
+  double r = sw->closed ? sw->r1 : (pc > 0 ? sw->r[pc - 1] : sw->r0);
 
   // Close
-  if (closed)
-    fprintf(file, "  <%f, %f, %f>, %f,\n", p[0].x, p[0].y, p[0].z, r);
+  if (sw->closed)
+    point(p[0], r, ",\n");
 
   // Control 2
-  if ((spType == SPLINEOBJECT_TYPE_CUBIC) || (spType == SPLINEOBJECT_TYPE_BSPLINE))
-    fprintf(file, "  <%f, %f, %f>, %f\n", p[pc - 1].x, p[pc - 1].y, p[pc - 1].z, r);
+  if (controls)
+    point(p[pc - 1], r, "\n");
+}
 
-  if(!at_root)
-  {
-    WriteMatrix(op);
-    WriteMaterial(op);
-  }
+void AlienSweepObjectData::Emit(SceneNode* node)
+{
+  const SweepPayload* sw = (const SweepPayload*)node->payload;
+
+  // Wrire
+  WriteDeclare(node);
+  WriteString("sphere_sweep  { ");
+  WriteString(sw->spTypeStr);
+  WriteString(" ");
+  WriteInt(sw->pn);
+  WriteString("\n\n");
+  SweepPath(sw, WriteSweepPoint);
+  WriteClose(node);
+}
 
-  // Close object  
-  fprintf(file, "}\n\n");
+//
+// Box of the spheres along the path: centers and radii are interpolated
+// by the same spline, so the extremes of center -/+ radius are curves of
+// the same kind
+//
+bool AlienSweepObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  const SweepPayload* sw = (const SweepPayload*)node->payload;
+  CurveBasis basis = sw->spType == SPLINEOBJECT_TYPE_CUBIC ? CURVE_CATMULL_ROM :
+                     sw->spType == SPLINEOBJECT_TYPE_BSPLINE ? CURVE_BSPLINE : CURVE_LINEAR;
 
-  ch2->SetExported();
-  exported = true;
-  printf("\n^---------------- SWEEP: EXPORT END ------------------^\n");
+  vector<CurvePoint> w;
+  vector<double> r;
+  SweepPath(sw, [&](const Vector& v, double radius, const char*)
+  {
+    w.push_back(ToCurvePoint(v));
+    r.push_back(radius);
+  });
 
+  for (int k = 0; k < 3; k++)
+  {
+    auto c = [&](size_t i) { return k == 0 ? w[i].x : (k == 1 ? w[i].y : w[i].z); };
+    double lo = HUGE_VAL, hi = -HUGE_VAL;
+    CurveRange(basis, w.size(), [&](size_t i) { return c(i) - r[i]; }, bounds.lo[k], hi);
+    CurveRange(basis, w.size(), [&](size_t i) { return c(i) + r[i]; }, lo, bounds.hi[k]);
+  }
   return true;
 }
 
 //
 // Lathe
 // 
+struct LathePayload
+{
+  Int32 spType;
+  Int32 pc;
+  const Vector* p;    // points and tangents of child spline
+  const Tangent* t;
+};
+
 Bool AlienLatheObjectData::Execute()
 {
-  printf("--------------- LATHE: EXPORT START -------------------\n");
+  LogTrace("--------------- LATHE: EXPORT START -------------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^------------- LATHE: Not exported - Disabled --------^\n");
+      LogTrace("\n^------------- LATHE: Not exported - Disabled --------^\n");
+      AddNode(NODE_LATHE, op, ObjectName(op), nullptr, false);  // keeps children in place
       return true;
     }
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^--------------- LATHE: Not exported - Render off --------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^--------------- LATHE: ALREADY EXPORTED -----------------^\n");
+    LogTrace("\n^--------------- LATHE: Not exported - Render off --------^\n");
     return true;
   }
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienLatheObjectData (%d): %s\n", (int)op->GetType(), objName);
-  }
-  else
-    printf("\n - AlienLatheObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienLatheObjectData (%d): %s\n", (int)op->GetType(), objName);
 
-  // Declare
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
+  // Child
+  AlienSplineObject* ch1 = (AlienSplineObject*)op->GetDown();
+  if (!ch1)
   {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
+    LogWarn("\n^--------------- LATHE: '%s' NOT EXPORTED - NO CHILD ------^\n", objName);
+    return true;
   }
 
-  DeleteMem(objName);
-
-  // Child
-  AlienSplineObject* ch1 = (AlienSplineObject*)op->GetDown();
   Char* ch1n = ch1->GetName().GetCStringCopy();
   if (ch1n)
   {
-    printf("\n   - Child_1: type='%d', name='%s'\n", (int)ch1->GetType(), ch1n);
+    LogTrace("\n   - Child_1: type='%d', name='%s'\n", (int)ch1->GetType(), ch1n);
     DeleteMem(ch1n);
   }
 
+  LathePayload* la = g_export->scene.arena.New<LathePayload>();
+
   // Spline type
-  Int32 spType = -1;
+  la->spType = -1;
   if (ch1->GetParameter(SPLINEOBJECT_TYPE, data))
-    spType = data.GetInt32();
+    la->spType = data.GetInt32();
 
   // Points
-  int pc = ch1->GetPointCount();
-  const Vector* p = ch1->GetPointR();
-
-  int tc = ch1->GetTangentCount();
-  const Tangent* t = ch1->GetTangentR();
+  la->pc = ch1->GetPointCount();
+  la->p = ch1->GetPointR();
+  la->t = ch1->GetTangentR();
+  bool native = la->spType == SPLINEOBJECT_TYPE_CUBIC || la->spType == SPLINEOBJECT_TYPE_BEZIER;
+  ResampleSpline(ch1, native, la->spType, la->pc, la->p, la->t);
+
+  SceneNode* node = AddNode(NODE_LATHE, op, objName, this, true);
+  node->payload = la;
+  HashValues(node, la->spType, la->pc);
+  HashNode(node, la->p, la->pc * sizeof(Vector));
+  if (la->t)
+    HashNode(node, la->t, la->pc * sizeof(Tangent));
+
+  LogTrace("^-------------- LATHE: EXPORT END -------------------^\n");
+  return true;
+}
 
-  // TODO: Choose by tag: linear_spline | quadratic_spline | cubic_spline | bezier_spline
+//
+// Lathe profile: point(x, y) for every written point
+//
+template <class F>
+static void LathePath(Int32 spType, int pc, const Vector* p, const Tangent* t, F point)
+{
   if (spType == SPLINEOBJECT_TYPE_CUBIC)
   {
-    // CUBIC spline
-    fprintf(file, "%slathe { cubic_spline %d\n\n", declare, pc + 2);
-    fprintf(file, "  <%f, %f>\n", p[0].x, p[0].y);  // Control 1
+    point(p[0].x, p[0].y);  // Control 1
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].y);
+      point(p[i].x, p[i].y);
     }
-    fprintf(file, "  <%f, %f>\n", p[pc - 1].x, p[pc - 1].y);  // Control 2
+    point(p[pc - 1].x, p[pc - 1].y);  // Control 2
   }
   else if (spType == SPLINEOBJECT_TYPE_BEZIER)
   {
-    // Write
-    fprintf(file, "%slathe { bezier_spline %d\n\n", declare, pc * 4);
     pc--;
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].y); // Point 1
-      fprintf(file, "  <%f, %f>\n", t[i].vr.x + p[i].x, t[i].vr.y + p[i].y); // Tangent 1
-      fprintf(file, "  <%f, %f>\n", t[i + 1].vl.x + p[i + 1].x, t[i + 1].vl.y + p[i + 1].y); // Tangent 2
-      fprintf(file, "  <%f, %f>\n", p[i + 1].x, p[i + 1].y); // Point 2
+      point(p[i].x, p[i].y); // Point 1
+      point(t[i].vr.x + p[i].x, t[i].vr.y + p[i].y); // Tangent 1
+      point(t[i + 1].vl.x + p[i + 1].x, t[i + 1].vl.y + p[i + 1].y); // Tangent 2
+      point(p[i + 1].x, p[i + 1].y); // Point 2
     }
 
-    fprintf(file, "  <%f, %f>\n", p[pc].x, p[pc].y); // Close
-    fprintf(file, "  <%f, %f>\n", t[pc].vr.x + p[pc].x, t[pc].vr.y + p[pc].y); // Tangent 1
-    fprintf(file, "  <%f, %f>\n", t[0].vl.x + p[0].x, t[0].vl.y + p[0].y);     // Tangent 2
-    fprintf(file, "  <%f, %f>\n", p[0].x, p[0].y);
+    point(p[pc].x, p[pc].y); // Close
+    point(t[pc].vr.x + p[pc].x, t[pc].vr.y + p[pc].y); // Tangent 1
+    point(t[0].vl.x + p[0].x, t[0].vl.y + p[0].y);     // Tangent 2
+    point(p[0].x, p[0].y);
   }
   else
   {
-    // LINEAR spline 
-    fprintf(file, "%slathe { linear_spline %d\n\n", declare, pc);
-
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  <%f, %f>\n", p[i].x, p[i].y);
+      point(p[i].x, p[i].y);
     }
-    fprintf(file, "\n");
   }
+}
+
+void AlienLatheObjectData::Emit(SceneNode* node)
+{
+  const LathePayload* la = (const LathePayload*)node->payload;
+  int pc = la->pc;
 
-  ch1->SetExported();
-  if(!at_root)
+  // TODO: Choose by tag: linear_spline | quadratic_spline | cubic_spline | bezier_spline
+  WriteDeclare(node);
+  if (la->spType == SPLINEOBJECT_TYPE_CUBIC)
+  {
+    // CUBIC spline
+    WriteString("lathe { cubic_spline ");
+    WriteInt(pc + 2);
+  }
+  else if (la->spType == SPLINEOBJECT_TYPE_BEZIER)
   {
-    WriteMatrix(op);
-    WriteMaterial(op);
+    WriteString("lathe { bezier_spline ");
+    WriteInt(pc * 4);
   }
+  else
+  {
+    // LINEAR spline 
+    WriteString("lathe { linear_spline ");
+    WriteInt(pc);
+  }
+  WriteString("\n\n");
+
+  LathePath(la->spType, pc, la->p, la->t, WritePoint2);
+  if (la->spType != SPLINEOBJECT_TYPE_CUBIC && la->spType != SPLINEOBJECT_TYPE_BEZIER)
+    WriteString("\n");
+
+  WriteClose(node);
+}
+
+//
+// Profile rotated around the y axis: the largest distance from the axis
+// bounds x and z
+//
+bool AlienLatheObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  const LathePayload* la = (const LathePayload*)node->payload;
+  CurveBasis basis = la->spType == SPLINEOBJECT_TYPE_CUBIC ? CURVE_CATMULL_ROM :
+                     la->spType == SPLINEOBJECT_TYPE_BEZIER ? CURVE_BEZIER : CURVE_LINEAR;
 
-  // Close object  
-  fprintf(file, "}\n\n");
+  vector<CurvePoint> w;
+  LathePath(la->spType, la->pc, la->p, la->t, [&](double x, double y) { w.push_back({ x, y, 0.0 }); });
 
-  printf("^-------------- LATHE: EXPORT END -------------------^\n", objName);
-  exported = true;
+  Bounds profile;
+  CurveBounds(basis, w, profile);
+  if (profile.Empty())
+    return true;
 
-  DeleteMem(objName);
+  double r = max(fabs(profile.lo[0]), fabs(profile.hi[0]));
+  bounds.Add(-r, profile.lo[1], -r);
+  bounds.Add(r, profile.hi[1], r);
   return true;
 }
 
@@ -3171,20 +4279,20 @@ Bool AlienInstanceObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienInstanceObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienInstanceObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienInstanceObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienInstanceObjectData (%d): <noname>\n", (int)op->GetType());
 
   Matrix m = op->GetMg();
   PrintMatrix(m);
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_USECOLOR, data) && data.GetInt32())
-    printf("   - UseDisplayColor: ON (Automatic/Layer...)\n");
+    LogTrace("   - UseDisplayColor: ON (Automatic/Layer...)\n");
   else
-    printf("   - UseDisplayColor: OFF\n");
+    LogTrace("   - UseDisplayColor: OFF\n");
 
   // detect the source (linked) object
   BaseObject* sourceObj = nullptr;
@@ -3195,13 +4303,13 @@ Bool AlienInstanceObjectData::Execute()
     pChar = sourceObj->GetName().GetCStringCopy();
     if (pChar)
     {
-      printf("   - Source: %s", pChar);
+      LogTrace("   - Source: %s", pChar);
       DeleteMem(pChar);
     }
     else
-      printf("   - Source: <noname>");
+      LogTrace("   - Source: <noname>");
   }
-  printf("\n");
+  LogTrace("\n");
 
   PrintUniqueIDs(this);
 
@@ -3217,11 +4325,11 @@ Bool AlienXRefObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienXRefObjectData (%d): %s\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienXRefObjectData (%d): %s\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienXRefObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienXRefObjectData (%d): <noname>\n", (int)op->GetType());
 
   GeData data;
   if (op->GetParameter(1000, data) && data.GetType() == DA_FILENAME)
@@ -3229,7 +4337,7 @@ Bool AlienXRefObjectData::Execute()
     pChar = data.GetFilename().GetString().GetCStringCopy();
     if (pChar)
     {
-      printf("   - external scene: %s\n", pChar);
+      LogTrace("   - external scene: %s\n", pChar);
       DeleteMem(pChar);
     }
   }
@@ -3239,17 +4347,403 @@ Bool AlienXRefObjectData::Execute()
   return true;
 }
 
+//
+// Outline of N-gon as point and polygon corner indices.
+// Returns false for N-gons with holes or unconnected edges.
+//
+static bool NgonOutline(const CPolygon* faces, const Pgon& ngon, vector<int>& verts, vector<int>& corners)
+{
+  verts.clear();
+  corners.clear();
+
+  Int32 ec = ngon.GetCount();
+  Int32 last = NOTOK;
+  for (Int32 e = 0; e < ec; e++)
+  {
+    PgonEdge* edge = ngon.GetEdge(e);
+    if (edge->IsSegmentEnd() && e < ec - 1)
+      return false;
+
+    Int32 ei = edge->EdgeIndex();
+    const CPolygon& f = faces[ei / 4];
+    Int32 side = ei % 4;
+    Int32 pts[4] = { f.a, f.b, f.c, f.d };
+    Int32 start = pts[side];
+    Int32 end = pts[(side + 1) % 4];
+
+    // Collapsed side of triangle
+    if (start == end)
+      continue;
+
+    if (last != NOTOK && last != start)
+      return false;
+
+    verts.push_back(start);
+    corners.push_back(ei);
+    last = end;
+  }
+
+  return verts.size() >= 3 && last == verts[0];
+}
+
+//
+// Triangulate mesh: one triangle per triangle, quads along the shorter
+// diagonal, N-gons by their outline
+//
+static void TriangulateMesh(PolygonObject* op, vector<MeshTriangle>& tris)
+{
+  const Vector* vertices = op->GetPointR();
+  const CPolygon* faces = op->GetPolygonR();
+  Int32 fc = op->GetPolygonCount();
+
+  tris.clear();
+  tris.reserve((size_t)fc * 2);
+
+  // N-gon state: 0 - not yet written, 1 - written, 2 - written as polygons
+  Int32 ngonCount = op->GetNgonCount();
+  NgonBase* ngonBase = ngonCount > 0 ? op->GetNgonBase() : nullptr;
+  vector<char> ngonState(ngonBase ? ngonCount : 0, 0);
+
+  vector<int> verts, corners;
+  for (Int32 i = 0; i < fc; ++i)
+  {
+    Int32 n = ngonBase ? ngonBase->FindPolygon(i) : NOTOK;
+    if (n != NOTOK && n < ngonCount)
+    {
+      if (ngonState[n] == 0)
+      {
+        bool ok = NgonOutline(faces, ngonBase->GetNgons()[n], verts, corners) &&
+                  TriangulateOutline(vertices, verts, corners, tris);
+        ngonState[n] = ok ? 1 : 2;
+      }
+      if (ngonState[n] == 1)
+        continue;
+    }
+
+    const CPolygon& f = faces[i];
+    TriangulatePolygon(vertices, i, f.a, f.b, f.c, f.d, tris);
+  }
+}
+
+//
+// N-gon layout: edge count and edge indices of every N-gon, empty if none.
+// Equal points and polygons triangulate differently with other N-gons.
+//
+static void GetNgons(PolygonObject* op, vector<Int32>& ngons)
+{
+  ngons.clear();
+  Int32 ngonCount = op->GetNgonCount();
+  NgonBase* ngonBase = ngonCount > 0 ? op->GetNgonBase() : nullptr;
+  if (!ngonBase)
+    return;
+
+  for (Int32 n = 0; n < ngonCount; n++)
+  {
+    const Pgon& ngon = ngonBase->GetNgons()[n];
+    Int32 ec = ngon.GetCount();
+    ngons.push_back(ec);
+    for (Int32 e = 0; e < ec; e++)
+      ngons.push_back(ngon.GetEdge(e)->EdgeIndex());
+  }
+}
+
+//
+// Mesh instancing: unique mesh content by hash of points, polygons,
+// N-gons, normals and UVs. Candidates with equal hash are compared
+// value by value. Normals and UVs are per corner (polygon * 4 + slot)
+// or nullptr.
+//
+
+static UInt64 MeshHash(PolygonObject* op, const Vector32* normals, const Vector* uvs, const vector<Int32>& ngons)
+{
+  Int32 vc = op->GetPointCount();
+  Int32 fc = op->GetPolygonCount();
+  UInt64 h = HashBytes(op->GetPointR(), vc * sizeof(Vector), vc);
+  h = HashBytes(op->GetPolygonR(), fc * sizeof(CPolygon), h ^ fc);
+  if (!ngons.empty())
+    h = HashBytes(ngons.data(), ngons.size() * sizeof(Int32), h ^ ngons.size());
+  if (normals)
+    h = HashBytes(normals, fc * 4 * sizeof(Vector32), h ^ 1);
+  if (uvs)
+    h = HashBytes(uvs, fc * 4 * sizeof(Vector), h ^ 2);
+  return h;
+}
+
+static bool SameMesh(const MeshEntry& e, PolygonObject* op, const Vector32* normals, const Vector* uvs, const vector<Int32>& ngons)
+{
+  PolygonObject* a = e.op;
+  Int32 vc = a->GetPointCount();
+  Int32 fc = a->GetPolygonCount();
+  if (vc != op->GetPointCount() || fc != op->GetPolygonCount() || e.ngons != ngons ||
+      !e.normals != !normals || !e.uvs != !uvs)
+    return false;
+
+  return !memcmp(a->GetPointR(), op->GetPointR(), vc * sizeof(Vector)) &&
+         !memcmp(a->GetPolygonR(), op->GetPolygonR(), fc * sizeof(CPolygon)) &&
+         (!normals || !memcmp(e.normals, normals, fc * 4 * sizeof(Vector32))) &&
+         (!uvs || !memcmp(e.uvs, uvs, fc * 4 * sizeof(Vector)));
+}
+
+// Name of already written mesh with the same content or nullptr
+static const char* FindMesh(PolygonObject* op, const Vector32* normals, const Vector* uvs, const vector<Int32>& ngons)
+{
+  auto it = g_export->meshes.find(MeshHash(op, normals, uvs, ngons));
+  if (it == g_export->meshes.end())
+    return nullptr;
+
+  for (const MeshEntry& e : it->second)
+    if (SameMesh(e, op, normals, uvs, ngons))
+      return e.name.c_str();
+  return nullptr;
+}
+
+// 'normals' and 'uvs' must stay valid until all meshes are found
+static const char* AddMesh(PolygonObject* op, const Vector32* normals, const Vector* uvs, const vector<Int32>& ngons)
+{
+  UInt64 h = MeshHash(op, normals, uvs, ngons);
+  vector<MeshEntry>& entries = g_export->meshes[h];
+
+  char name[64];
+  sprintf(name, "Mesh_%016llx", (unsigned long long)h);
+  if (!entries.empty())
+    sprintf(name + strlen(name), "_%d", (int)entries.size());
+
+  entries.push_back({ op, normals, uvs, ngons, name });
+  g_export->meshCount++;
+  return entries.back().name.c_str();
+}
+
+//
+// Per-corner UVs (polygon * 4 + slot) from the first UVW tag, empty if none
+//
+static void GetCornerUVs(PolygonObject* op, vector<Vector>& uvs)
+{
+  uvs.clear();
+  UVWTag* tag = (UVWTag*)op->GetTag(Tuvw);
+  Int32 fc = op->GetPolygonCount();
+  if (!tag || tag->GetDataCount() != fc)
+    return;
+
+  ConstUVWHandle data = tag->GetDataAddressR();
+  if (!data)
+    return;
+
+  uvs.resize((size_t)fc * 4);
+  UVWStruct uvw;
+  for (Int32 i = 0; i < fc; i++)
+  {
+    UVWTag::Get(data, i, uvw);
+    uvs[i * 4]     = Vector(uvw.a.x, uvw.a.y, 0.0);
+    uvs[i * 4 + 1] = Vector(uvw.b.x, uvw.b.y, 0.0);
+    uvs[i * 4 + 2] = Vector(uvw.c.x, uvw.c.y, 0.0);
+    uvs[i * 4 + 3] = Vector(uvw.d.x, uvw.d.y, 0.0);
+  }
+}
+
+//
+// Decimated proxy: opens the declaration of the mesh,
+//
+//   #declare <meshName> =
+//   #if (C2P_Proxy) mesh2 { ... } #else
+//
+// the full mesh and #end follow. The first proxy mesh of the scene
+// writes the C2P_Proxy default.
+//
+static void WriteProxyMesh(const Vector* vertices, const vector<int>& used, const vector<MeshTriangle>& tris, const char* meshName, bool proxySwitch)
+{
+  vector<MeshPoint> pts(used.size());
+  for (size_t i = 0; i < used.size(); i++)
+  {
+    const Vector& v = vertices[used[i]];
+    pts[i] = { v.x, v.y, v.z };
+  }
+
+  vector<MeshTriangle> ptris = tris;
+  DecimateMesh(pts, ptris, g_proxyRatio, g_proxyError);
+  Int32 pc = (Int32)pts.size();
+  Int32 tc = (Int32)ptris.size();
+
+  if (proxySwitch)
+    WriteString("#ifndef (C2P_Proxy)\n  #declare C2P_Proxy = off;\n#end\n\n");
+
+  WriteString("#declare ");
+  WriteString(meshName);
+  WriteString(" =\n#if (C2P_Proxy)\nmesh2 {\n\nvertex_vectors{ ");
+  WriteInt(pc);
+  WriteString(",\n");
+  WriteLines(*sink, pc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+  {
+    return FormatVec3Line(p, pts[i].x, pts[i].y, pts[i].z, g_meshFormat);
+  });
+  WriteString("}\n\nface_indices { ");
+  WriteInt(tc);
+  WriteString(",\n");
+  WriteLines(*sink, tc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+  {
+    const MeshTriangle& t = ptris[i];
+    return FormatIndex3Line(p, t.v[0], t.v[1], t.v[2]);
+  });
+  WriteString("}\n}\n#else\n");
+
+  LogTrace("   - Proxy: %d points, %d triangles\n", (int)pc, (int)tc);
+}
+
+//
+// Write mesh data: #declare <meshName> = mesh2 { ... }. Runs on emitter
+// threads: everything read from the SDK object is taken by Execute().
+//
+static void WriteMesh(const Vector* vertices, Int32 vc, Int32 fc, const MeshTriangle* triangles, Int32 tc,
+                      const Vector32* normals, const Vector* uvs, const char* meshName, bool proxySwitch)
+{
+  // Welded points
+  vector<MeshTriangle> tris(triangles, triangles + tc);
+
+  vector<int> used;
+  Int32 welded = WeldPoints(vertices, vc, g_weldEpsilon, tris, used);
+  Int32 uc = (Int32)used.size();
+  Int32 dropped = tc - (Int32)tris.size();
+  tc = (Int32)tris.size();
+
+  if (g_mortonOrder)
+    MortonOrder(vertices, used, tris);
+
+  // Proxy
+  bool proxy = g_proxyRatio < 1.0 || g_proxyError > 0.0;
+  if (proxy)
+    WriteProxyMesh(vertices, used, tris, meshName, proxySwitch);
+
+  // Mesh
+  if (!proxy)
+  {
+    WriteString("#declare ");
+    WriteString(meshName);
+    WriteString(" = ");
+  }
+  WriteString("mesh2 {\n\nvertex_vectors{ ");
+  WriteInt(uc);
+  WriteString(",\n");
+
+  // Vertices
+  WriteLines(*sink, uc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+  {
+    const Vector& v = vertices[used[i]];
+    return FormatVec3Line(p, v.x, v.y, v.z, g_meshFormat);
+  });
+  WriteString("}\n\n");
+
+  // Nornals - unique corner normals
+  vector<int> ntable, nindices;
+
+  if (normals)
+  {
+    IndexCorners(normals, tris, ntable, nindices);
+    Int32 nc = (Int32)ntable.size();
+
+    WriteString("normal_vectors{ ");
+    WriteInt(nc);
+    WriteString(",\n");
+    WriteLines(*sink, nc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+    {
+      const Vector32& n = normals[ntable[i]];
+      return FormatVec3Line(p, n.x, n.y, n.z, g_meshFormat);
+    });
+    WriteString("}\n\n");
+  }
+
+  // UVs - unique corner UVs, v flipped
+  vector<int> utable, uindices;
+
+  if (uvs)
+  {
+    IndexCorners(uvs, tris, utable, uindices);
+    Int32 uvc = (Int32)utable.size();
+
+    WriteString("uv_vectors{ ");
+    WriteInt(uvc);
+    WriteString(",\n");
+    WriteLines(*sink, uvc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+    {
+      const Vector& uv = uvs[utable[i]];
+      return FormatVec2Line(p, uv.x, 1.0 - uv.y, g_meshFormat);
+    });
+    WriteString("}\n\n");
+  }
+
+  // Faces
+  WriteString("face_indices { ");
+  WriteInt(tc);
+  WriteString(",\n");
+  WriteLines(*sink, tc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+  {
+    const MeshTriangle& t = tris[i];
+    return FormatIndex3Line(p, t.v[0], t.v[1], t.v[2]);
+  });
+  WriteString("}\n");
+
+  // Normal indices
+  if (normals)
+  {
+    WriteString("\nnormal_indices { ");
+    WriteInt(tc);
+    WriteString(",\n");
+    WriteLines(*sink, tc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+    {
+      return FormatIndex3Line(p, nindices[i * 3], nindices[i * 3 + 1], nindices[i * 3 + 2]);
+    });
+    WriteString("}\n");
+    LogTrace("   - Normals: %d (%d corners)\n", (int)ntable.size(), (int)(tc * 3));
+  }
+
+  // UV indices
+  if (uvs)
+  {
+    WriteString("\nuv_indices { ");
+    WriteInt(tc);
+    WriteString(",\n");
+    WriteLines(*sink, tc, MAX_LINE_CHARS, lineThreads, [&](char* p, size_t i)
+    {
+      return FormatIndex3Line(p, uindices[i * 3], uindices[i * 3 + 1], uindices[i * 3 + 2]);
+    });
+    WriteString("}\n");
+    LogTrace("   - UVs: %d (%d corners)\n", (int)utable.size(), (int)(tc * 3));
+  }
+
+  LogTrace("   - Points: %d (%d welded, %d unused)\n", (int)uc, (int)welded, (int)(vc - uc - welded));
+  if (dropped > 0)
+    LogTrace("   - Collapsed triangles: %d\n", (int)dropped);
+  LogTrace("   - Triangles: %d (%d saved)\n", (int)tc, (int)(fc * 2 - tc));
+  g_export->trianglesSaved += fc * 2 - tc;
+
+  WriteString(proxy ? "}\n#end\n\n" : "}\n\n");
+}
+
 // 
 // Mesh (Polygons)
 // 
+struct MeshPayload
+{
+  const char* meshName;
+  bool first;          // first instance writes the mesh data
+  Vector32* normals;   // of first instance, freed when written
+  const Vector* uvs;   // of first instance, per corner, nullptr if none
+  bool proxySwitch;    // first proxy mesh, writes C2P_Proxy default
+
+  // SDK data, read by Execute(): emitters run on several threads
+  const Vector* vertices;
+  Int32 vc;
+  Int32 fc;
+  const MeshTriangle* tris;   // of first instance
+  Int32 tc;
+};
+
 Bool AlienPolygonObjectData::Execute()
 {
-  printf("\n--------------- MESH: RENDER START --------------------\n");
+  LogTrace("\n--------------- MESH: RENDER START --------------------\n");
   PolygonObject* op = (PolygonObject*)GetNode();
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^-------------- MESH: NOT EXPORTED - Render off ------^\n");
+    LogTrace("\n^-------------- MESH: NOT EXPORTED - Render off ------^\n");
     return true;
   }
 
@@ -3267,88 +4761,65 @@ Bool AlienPolygonObjectData::Execute()
   if (!vertices || (!faces && fc > 0))
     return false;
 
-  // Get name of object as string copy (free it after usage!)
-  Char* objName = op->GetName().GetCStringCopy();
-  if (!objName)
-    objName = String("noname").GetCStringCopy();
-  else
-    MakeValidName(objName);
-
-  printf("\n - AlienPolygonObject (%d): %s\n", (int)op->GetType(), objName);
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienPolygonObject (%d): %s\n", (int)op->GetType(), objName);
   PrintUniqueIDs(this);
   
-  printf("   - PointCount: %d PolygonCount: %d\n", (int)vc, (int)fc);
+  LogTrace("   - PointCount: %d PolygonCount: %d\n", (int)vc, (int)fc);
   PrintMatrix(op->GetMg());
   PrintUserData(op);
 
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
-  {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
-  }
-
-  // Mesh
-  fprintf(file, "%smesh2 {\n\nvertex_vectors{ %d,\n", declare, vc);
-
-  // Vertices
-  for (int i = 0; i < vc; ++i)
-  {
-    fprintf(file, "<%4.10f, %4.10f, %4.10f>\n", vertices[i].x, vertices[i].y, vertices[i].z);
-  }
-  fprintf(file, "}\n\n");
-
-  // Nornals
-  Vector32* nvert;
+  // Unique mesh data, declared once
+  MeshPayload* mesh = g_export->scene.arena.New<MeshPayload>();
+  mesh->vertices = vertices;
+  mesh->vc = vc;
+  mesh->fc = fc;
   Vector32* normals = op->CreatePhongNormals();
+  vector<Vector> uvs;
+  GetCornerUVs(op, uvs);
+  vector<Int32> ngons;
+  GetNgons(op, ngons);
 
-  if (normals)
+  mesh->meshName = FindMesh(op, normals, uvs.empty() ? nullptr : uvs.data(), ngons);
+  if (!mesh->meshName)
   {
-    // Prepare normals array corresponding to vertices
-    nvert = new Vector32[vc];
-    for (int i = 0; i < fc; ++i)
+    mesh->first = true;
+    mesh->normals = normals;
+    if (!uvs.empty())
     {
-      int ni = i * 4;
-      nvert[faces[i].a] = normals[ni];
-      nvert[faces[i].b] = normals[ni + 1];
-      nvert[faces[i].c] = normals[ni + 2];
+      Vector* copy = g_export->scene.arena.NewArray<Vector>(uvs.size());
+      memcpy(copy, uvs.data(), uvs.size() * sizeof(Vector));
+      mesh->uvs = copy;
     }
-
-    // Wrire
-    fprintf(file, "normal_vectors{ %d,\n", vc);
-    for (int i = 0; i < vc; ++i)
+    mesh->meshName = AddMesh(op, normals, mesh->uvs, ngons);
+
+    vector<MeshTriangle> tris;
+    TriangulateMesh(op, tris);
+    MeshTriangle* triangles = g_export->scene.arena.NewArray<MeshTriangle>(tris.size());
+    copy_n(tris.begin(), tris.size(), triangles);
+    mesh->tris = triangles;
+    mesh->tc = (Int32)tris.size();
+    if ((g_proxyRatio < 1.0 || g_proxyError > 0.0) && !g_export->proxySwitch)
     {
-      fprintf(file, "<%4.10f, %4.10f, %4.10f>\n", nvert[i].x, nvert[i].y, nvert[i].z);
+      mesh->proxySwitch = true;
+      g_export->proxySwitch = true;
     }
-    fprintf(file, "}\n\n");
-  }
-
-  // Faces
-  fprintf(file, "face_indices { %d,\n", fc * 2);
-  for (int i = 0; i < fc; ++i)
-  {
-    fprintf(file, "<%d, %d, %d>\n", faces[i].a, faces[i].b, faces[i].c);
-    fprintf(file, "<%d, %d, %d>\n", faces[i].a, faces[i].c, faces[i].d);
   }
-  fprintf(file, "}\n");
-
-  if (!at_root)
+  else
   {
-    WriteMatrix(op);
-    WriteMaterial(op);
+    LogTrace("   - Instance of %s\n", mesh->meshName);
+    g_export->meshInstances++;
+    if (normals)
+      DeleteMem(normals);
   }
 
-  // Close object  
-  fprintf(file, "}\n\n");
-
-  if (normals)
-  {
-    DeleteMem(normals);
-    delete(nvert);
-  }
+  // The mesh name is derived from the content hash of the mesh data
+  SceneNode* node = AddNode(NODE_MESH, op, objName, this, true);
+  node->payload = mesh;
+  HashNode(node, mesh->meshName);
+  HashValues(node, mesh->first, mesh->proxySwitch);
 
-  printf("\n^-------------- MESH: RENDER END ---------------------^\n");
+  LogTrace("\n^-------------- MESH: RENDER END ---------------------^\n");
   return true;
 
   /*----------------------- Preserved for future use ------------------------
@@ -3356,31 +4827,31 @@ Bool AlienPolygonObjectData::Execute()
   Int32 ncnt = op->GetNgonCount();
   if (ncnt > 0)
   {
-    printf("\n   - %d Ngons found\n", (int)ncnt);
+    LogTrace("\n   - %d Ngons found\n", (int)ncnt);
     for (Int32 n = 0; n < ncnt && n < 3; n++) // show only 3
     {
-      printf("     Ngon %d with %d Edges\n", (int)n, (int)op->GetNgonBase()->GetNgons()[n].GetCount());
+      LogTrace("     Ngon %d with %d Edges\n", (int)n, (int)op->GetNgonBase()->GetNgons()[n].GetCount());
       for (Int32 p = 0; p < fc && p < 3; p++)
       {
         Int32 polyid = op->GetNgonBase()->FindPolygon(p);
         if (polyid != NOTOK)
-          printf("     Polygon %d is included in Ngon %d\n", (int)p, (int)polyid);
+          LogTrace("     Polygon %d is included in Ngon %d\n", (int)p, (int)polyid);
         else
-          printf("     Polygon %d is NOT included in any Ngon\n", (int)p);
+          LogTrace("     Polygon %d is NOT included in any Ngon\n", (int)p);
         if (p == 2)
-          printf("     ...\n");
+          LogTrace("     ...\n");
       }
       for (Int32 e = 0; e<op->GetNgonBase()->GetNgons()[n].GetCount() && e < 3; e++)
       {
         PgonEdge *pEdge = op->GetNgonBase()->GetNgons()[n].GetEdge(e);
-        printf("     Edge %d: eidx: %d pid: %d sta: %d f:%d e:%d\n", (int)e, (int)pEdge->EdgeIndex(), (int)pEdge->ID(), (int)pEdge->State(), (int)pEdge->IsFirst(), (int)pEdge->IsSegmentEnd());
+        LogTrace("     Edge %d: eidx: %d pid: %d sta: %d f:%d e:%d\n", (int)e, (int)pEdge->EdgeIndex(), (int)pEdge->ID(), (int)pEdge->State(), (int)pEdge->IsFirst(), (int)pEdge->IsSegmentEnd());
         if (e == 2)
-          printf("     ...\n");
+          LogTrace("     ...\n");
       }
       if (ncnt == 2)
-        printf("     ...\n");
+        LogTrace("     ...\n");
     }
-    printf("\n");
+    LogTrace("\n");
   }
 
   // tag info
@@ -3394,11 +4865,11 @@ Bool AlienPolygonObjectData::Execute()
     pChar = pLay->GetName().GetCStringCopy();
     if (pChar)
     {
-      printf("   - Layer (%d): %s\n", (int)pLay->GetType(), pChar);
+      LogTrace("   - Layer (%d): %s\n", (int)pLay->GetType(), pChar);
       DeleteMem(pChar);
     }
     else
-      printf("   - Layer (%d): <noname>\n", (int)pLay->GetType());
+      LogTrace("   - Layer (%d): <noname>\n", (int)pLay->GetType());
   }
   
   if (op->GetFirstCTrack())
@@ -3406,17 +4877,61 @@ Bool AlienPolygonObjectData::Execute()
   -------------------------------------------------------------------------*/
 }
 
+void AlienPolygonObjectData::Emit(SceneNode* node)
+{
+  MeshPayload* mesh = (MeshPayload*)node->payload;
+  if (mesh->first)
+  {
+    WriteMesh(mesh->vertices, mesh->vc, mesh->fc, mesh->tris, mesh->tc, mesh->normals, mesh->uvs, mesh->meshName, mesh->proxySwitch);
+    if (mesh->normals)
+      DeleteMem(mesh->normals);
+    mesh->normals = nullptr;
+  }
+
+  // Reference
+  WriteDeclare(node);
+  WriteString("object { ");
+  WriteString(mesh->meshName);
+  WriteString("\n");
+  WriteClose(node);
+}
+
+//
+// Box of the full mesh. Proxy vertices are placed at the quadric optimum
+// and may lie outside of it, meshes with proxies stay unbounded.
+//
+bool AlienPolygonObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  if (g_proxyRatio < 1.0 || g_proxyError > 0.0)
+    return false;
+
+  PolygonObject* op = (PolygonObject*)node->source;
+  const Vector* vertices = op->GetPointR();
+  Int32 vc = op->GetPointCount();
+  for (Int32 i = 0; vertices && i < vc; i++)
+    bounds.Add(vertices[i].x, vertices[i].y, vertices[i].z);
+  return true;
+}
+
+void AlienPolygonObjectData::Skip(SceneNode* node)
+{
+  MeshPayload* mesh = (MeshPayload*)node->payload;
+  if (mesh->normals)
+    DeleteMem(mesh->normals);
+  mesh->normals = nullptr;
+}
+
 // Execute function for the self defined Layer
 Bool AlienLayer::Execute()
 {
   Char *pChar = GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienLayer: \"%s\"", pChar);
+    LogTrace("\n - AlienLayer: \"%s\"", pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienLayer: <noname>");
+    LogTrace("\n - AlienLayer: <noname>");
 
   // access and print layer data
   GeData data;
@@ -3442,14 +4957,12 @@ Bool AlienLayer::Execute()
   l = (data.GetInt32() != 0);
   GetParameter(DescID(ID_LAYER_COLOR), data);
   c = data.GetVector();
-  printf(" - S%d V%d R%d M%d L%d A%d G%d D%d E%d C%d/%d/%d\n",s,v,r,m,l,a,g,d,e,(int)(c.x*255.0),(int)(c.y*255.0),(int)(c.z*255.0));
+  LogTrace(" - S%d V%d R%d M%d L%d A%d G%d D%d E%d C%d/%d/%d\n",s,v,r,m,l,a,g,d,e,(int)(c.x*255.0),(int)(c.y*255.0),(int)(c.z*255.0));
 
   PrintUniqueIDs(this);
 
   // assign a id to the layer
-  layId = g_tempLayID;
-
-  g_tempLayID++;
+  layId = g_export->layId++;
 
   return true;
 }
@@ -3457,28 +4970,21 @@ Bool AlienLayer::Execute()
 //
 // Camera
 //
+struct CameraPayload
+{
+  Float fov;
+};
+
 Bool AlienCameraObjectData::Execute()
 {
-  printf("\n--------------- CAMERA: EXPORT START ------------------\n");
+  LogTrace("\n--------------- CAMERA: EXPORT START ------------------\n");
   BaseObject* op = (BaseObject*)GetNode();
-  Char* objName = op->GetName().GetCStringCopy();
-  if (objName)
-  {
-    printf("\n - AlienCameraObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
-    DeleteMem(objName);
-  }
-  else
-    printf("\n - AlienCameraObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienCameraObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^------------ CAMERA: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^---------------- CAMERA: Already exported -----------------^\n");
+    LogTrace("\n^------------ CAMERA: Not exported - Render off ------^\n");
     return true;
   }
 
@@ -3494,11 +5000,11 @@ Bool AlienCameraObjectData::Execute()
   if (op->GetParameter(CAMERA_PROJECTION, camData))
     proj = (int)camData.GetInt32();
 
-  printf("\n - Projection type: %d \n", proj);
+  LogTrace("\n - Projection type: %d \n", proj);
 
   if (proj != Pperspective)
   {
-    printf("\n - CAMERA: Not exported - only perspective projection (type '%d') is supported\n\n", Pperspective);
+    LogWarn("\n - CAMERA: '%s' Not exported - only perspective projection (type '%d') is supported\n\n", objName, Pperspective);
     return true;
   }
 
@@ -3506,11 +5012,9 @@ Bool AlienCameraObjectData::Execute()
   Float fov = -1;
   if (op->GetParameter(CAMERAOBJECT_FOV, camData))
     fov = RadToDeg(camData.GetFloat());
-  printf("   FOV: %f \n", fov);
+  LogTrace("   FOV: %f \n", fov);
 
   // Only perspective supported now
-  string ptojStr = "perspective";
-
   // TODO: Find Zoom -> angle function
   /*
   Float zoom = 1;
@@ -3521,39 +5025,59 @@ Bool AlienCameraObjectData::Execute()
     // Zoom
     if (op->GetParameter(CAMERA_ZOOM, camData))
       zoom = camData.GetFloat();
-    printf("   Zoom: %f \n", zoom);
+    LogTrace("   Zoom: %f \n", zoom);
     zoom = zoom / ZOOM_FACTOR;
   }
   */
 
-  fprintf(file, "camera{\
-  %s\n\
-  location  <0, 0, 0>\n\
-  angle %f\n", ptojStr.c_str(), fov);
+  CameraPayload* cp = g_export->scene.arena.New<CameraPayload>();
+  cp->fov = fov;
 
-  WriteMatrix(op);
-  fprintf(file, "}\n\n");
-
-  printf("\n^--------------- CAMERA: EXPORT END ------------------^\n");
-  exported = true;
+  SceneNode* node = AddNode(NODE_CAMERA, op, objName, this, false);
+  node->payload = cp;
+  HashValues(node, cp->fov);
 
+  LogTrace("\n^--------------- CAMERA: EXPORT END ------------------^\n");
   return true;
 }
 
+void AlienCameraObjectData::Emit(SceneNode* node)
+{
+  const CameraPayload* cp = (const CameraPayload*)node->payload;
+
+  WriteString("camera{  perspective\n  location  <0, 0, 0>\n  angle ");
+  WriteParam(node, 0, cp->fov);
+  WriteString("\n");
+
+  WriteMatrix(node);
+  WriteString("}\n\n");
+}
+
+int AlienCameraObjectData::Animate(SceneNode* node, double* values)
+{
+  GeData data;
+  BaseObject* op = (BaseObject*)GetNode();
+  values[0] = op->GetParameter(CAMERAOBJECT_FOV, data) ? RadToDeg(data.GetFloat()) : -1;
+  return 1;
+}
+
 //
 // Spline
 //
+struct SplinePayload
+{
+  int export_as;
+  const char* spline_type_str;
+  int pc;
+  const Vector* p;
+  double* len;        // cumulative arc length at points with --arc-length, else nullptr
+};
+
 Bool AlienSplineObject::Execute()
 {
-  printf("--------------- SPLINE: EXPORT START ------------------\n");
-  Char* objName = GetName().GetCStringCopy();
-  if (objName)
-  {
-    MakeValidName(objName);
-    printf("\n - AlienSplineObject (%d): %s\n", (int)GetType(), objName);
-  }
-  else
-    printf("\n - AlienSplineObject (%d): <noname>\n", (int)GetType());
+  LogTrace("--------------- SPLINE: EXPORT START ------------------\n");
+  const char* objName = ObjectName(this);
+  LogTrace("\n - AlienSplineObject (%d): %s\n", (int)GetType(), objName);
 
   PrintUniqueIDs(this);
   PrintTagInfo(this);
@@ -3562,29 +5086,23 @@ Bool AlienSplineObject::Execute()
   if (GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^------------ SPLINE: Not exported - Disabled --------^\n");
+      LogTrace("\n^------------ SPLINE: Not exported - Disabled --------^\n");
       return true;
     }
 
   if (GetRenderMode() == MODE_OFF)
   {
-    printf("\n^------------ SPLINE: Not exported - Render off ------^\n");
-    return true;
-  }
-
-  if (exported)
-  {
-    printf("\n^--------------- SPLINE: Already exported ------------^\n");
+    LogTrace("\n^------------ SPLINE: Not exported - Render off ------^\n");
     return true;
   }
 
   // POV Tag
-  int export_as;
-  int spline_type;
-  printf("-- Check for POV Tag ---\n");
+  int export_as = 0;
+  int spline_type = POV_SPLINE_SPLINE_LINEAR;
+  LogTrace("-- Check for POV Tag ---\n");
   if (HasSplineTag(this, export_as, spline_type))
   {
-    printf("-- POV Tag: export_as=%d, spline_type=%d\n", export_as, spline_type);
+    LogTrace("-- POV Tag: export_as=%d, spline_type=%d\n", export_as, spline_type);
   }
 
   Int32 iType = -1;
@@ -3593,19 +5111,19 @@ Bool AlienSplineObject::Execute()
   switch (iType)
   {
     case SPLINEOBJECT_INTERPOLATION_NONE:
-      printf("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_NONE\n");
+      LogTrace("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_NONE\n");
       break;
     case SPLINEOBJECT_INTERPOLATION_NATURAL:
-      printf("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_NATURAL\n");
+      LogTrace("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_NATURAL\n");
       break;
     case SPLINEOBJECT_INTERPOLATION_UNIFORM:
-      printf("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_UNIFORM\n");
+      LogTrace("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_UNIFORM\n");
       break;
     case SPLINEOBJECT_INTERPOLATION_ADAPTIVE:
-      printf("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_ADAPTIVE\n");
+      LogTrace("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_ADAPTIVE\n");
       break;
     case SPLINEOBJECT_INTERPOLATION_SUBDIV:
-      printf("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_SUBDIV\n");
+      LogTrace("   - Interpolation Type: SPLINEOBJECT_INTERPOLATION_SUBDIV\n");
       break;
   }
 
@@ -3613,20 +5131,25 @@ Bool AlienSplineObject::Execute()
   PrintMatrix(GetMg());
 
   // Write spline data
-  int pc = GetPointCount();
-  int type;
+  Int32 pc = GetPointCount();
+  Int32 type = -1;
   int sc = (int)GetSegmentCount();
 
   if (GetParameter(SPLINEOBJECT_TYPE, data))
   {
-    type = (int)data.GetInt32();
-    printf("   - SplineType: %d\n", type);
+    type = data.GetInt32();
+    LogTrace("   - SplineType: %d\n", (int)type);
   }
 
-  printf("   - PointCount: %d\n", pc);
-  printf("   - SegmentCount: %d\n", sc);
+  LogTrace("   - PointCount: %d\n", (int)pc);
+  LogTrace("   - SegmentCount: %d\n", sc);
 
-  string spline_type_str = "linear_spline";
+  // Points, curves resampled for arrays of their shape
+  const Vector* p = GetPointR();
+  const Tangent* t = GetTangentR();
+  ResampleSpline(this, false, type, pc, p, t);
+
+  const char* spline_type_str = "linear_spline";
   switch (spline_type)
   {
     case POV_SPLINE_SPLINE_QUADRATIC: spline_type_str = "quadratic_spline"; break;
@@ -3634,270 +5157,475 @@ Bool AlienSplineObject::Execute()
     case POV_SPLINE_SPLINE_NATURAL:   spline_type_str = "natural_spline";   break;
   }
 
-  char name[MAX_OBJ_NAME];
+  // Child splines of generators are registered too, but not emitted
+  SplinePayload* sp = g_export->scene.arena.New<SplinePayload>();
+  sp->export_as = export_as;
+  sp->spline_type_str = spline_type_str;
+  sp->pc = pc;
+  sp->p = p;
+  sp->len = nullptr;
+  if (g_arcLengthKeys && pc > 1)
+  {
+    vector<double> len;
+    ArcLengthTable(p, pc, len);
+    sp->len = g_export->scene.arena.NewArray<double>(pc);
+    copy(len.begin(), len.end(), sp->len);
+  }
+
+  SceneNode* node = AddNode(NODE_SPLINE, this, objName, this, false);
+  node->payload = sp;
+  HashNode(node, sp->spline_type_str);
+  HashValues(node, sp->export_as, sp->pc, g_arcLengthKeys);
+  HashNode(node, sp->p, sp->pc * sizeof(Vector));
+
+  LogTrace("^-------------- SPLINE: EXPORT END -----------------^\n");
+  return true;
+}
+
+//
+// Arc length lookup: C2P_ArcIndex(Len, D) finds the segment of distance D
+// in the cumulative length table Len by binary search, C2P_ArcPoint(Arr,
+// Len, D) interpolates the point at D in the matching spline array:
+//   #for (K, 0, N - 1) C2P_ArcPoint(arr_S, len_S, K * S_length / (N - 1)) #end
+//
+static const char* ARC_LENGTH_MACROS =
+"#ifndef (C2P_ArcMacros)\n\
+  #declare C2P_ArcMacros = on;\n\
+  #macro C2P_ArcIndex(Len, D)\n\
+    #local Lo = 0;\n\
+    #local Hi = dimension_size(Len, 1) - 1;\n\
+    #while (Hi - Lo > 1)\n\
+      #local Mid = div(Lo + Hi, 2);\n\
+      #if (Len[Mid] <= D) #local Lo = Mid; #else #local Hi = Mid; #end\n\
+    #end\n\
+    Lo\n\
+  #end\n\
+  #macro C2P_ArcPoint(Arr, Len, D)\n\
+    #local I = C2P_ArcIndex(Len, D);\n\
+    #local J = min(I + 1, dimension_size(Len, 1) - 1);\n\
+    #local F = (Len[J] > Len[I] ? (D - Len[I]) / (Len[J] - Len[I]) : 0);\n\
+    (Arr[I][1] + F * (Arr[J][1] - Arr[I][1]))\n\
+  #end\n\
+#end\n\n";
+
+void AlienSplineObject::Emit(SceneNode* node)
+{
+  const SplinePayload* sp = (const SplinePayload*)node->payload;
+  const char* objName = node->name;
+  int export_as = sp->export_as;
+  int pc = sp->pc;
+  const Vector* p = sp->p;
+
+  // Keys: normalized arc length, or point index
+  const double* len = sp->len;
+  double total = len ? len[pc - 1] : 0.0;
+  auto key = [&](int i) { return !len ? (double)i / (double)pc : (total > 0.0 ? len[i] / total : (double)i / (pc - 1)); };
+
+  // Cumulative length table and total length
+  if (len && export_as >= POV_SPLINE_AS_SPLINE && export_as <= POV_SPLINE_BOTH)
+  {
+    WriteString("#declare ");
+    WriteString(objName);
+    WriteString("_length = ");
+    WriteFloat(total);
+    WriteString(";\n#declare len_");
+    WriteString(objName);
+    WriteString(" = array[");
+    WriteInt(pc);
+    WriteString("] {");
+    for (int i = 0; i < pc; ++i)
+    {
+      WriteString(i % 8 ? ", " : (i ? ",\n  " : "\n  "));
+      WriteFloat(len[i]);
+    }
+    WriteString("\n}\n\n");
+  }
 
   // Write array
   if ((export_as == POV_SPLINE_AS_ARRAY) ||
       (export_as == POV_SPLINE_BOTH))
   {
-    sprintf(name, "arr_%s", objName);
+    if (len)
+      WriteString(ARC_LENGTH_MACROS);
 
-    fprintf(file, "#declare %s_size = %d;\n\
-  #declare %s = array mixed [%s_size][2] {\n\n", objName, pc, name, objName);
+    WriteString("#declare ");
+    WriteString(objName);
+    WriteString("_size = ");
+    WriteInt(pc);
+    WriteString(";\n  #declare arr_");
+    WriteString(objName);
+    WriteString(" = array mixed [");
+    WriteString(objName);
+    WriteString("_size][2] {\n\n");
 
-    const Vector* p = GetPointR();
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  { %f, <%f, %f, %f>}\n", (double)i / (double)pc, p[i].x, p[i].z, p[i].y);
+      WriteString("  { ");
+      WriteFloat(key(i));
+      WriteString(", ");
+      WriteVec3(p[i].x, p[i].z, p[i].y);
+      WriteString("}\n");
     }
-    fprintf(file, "}\n\n");
+    WriteString("}\n\n");
   }
   
   // Wrtie spline
   if ((export_as == POV_SPLINE_AS_SPLINE) ||
       (export_as == POV_SPLINE_BOTH))
   {
-    sprintf(name, "spl_%s", objName);
-
-    fprintf(file, "#declare %s = spline { %s\n\n", name, spline_type_str.c_str());
-    const Vector* p = GetPointR();
+    WriteString("#declare spl_");
+    WriteString(objName);
+    WriteString(" = spline { ");
+    WriteString(sp->spline_type_str);
+    WriteString("\n\n");
     for (int i = 0; i < pc; ++i)
     {
-      fprintf(file, "  %f, <%f, %f, %f>\n", (double)i / (double)pc, p[i].x, p[i].z, p[i].y);
+      WriteString("  ");
+      WriteFloat(key(i));
+      WriteString(", ");
+      WriteVec3(p[i].x, p[i].z, p[i].y);
+      WriteString("\n");
     }
-    fprintf(file, "}\n\n");
+    WriteString("}\n\n");
   }
-
-  if (objName)
-    DeleteMem(objName);
-
-  printf("^-------------- SPLINE: EXPORT END -----------------^\n");
-  return true;
 }
 
 //
 // Primitives
 //
-Bool AlienPrimitiveObjectData::Execute()
+struct PrimitivePayload
 {
-  printf("------------ PRIMITIVE: EXPORT START ----------------\n");
+  Int32 type;
+  Float v[3];   // size or radii, see Emit()
+};
+
+//
+// Size parameters of primitive 'type', false if unsupported
+//
+static bool PrimitiveValues(BaseObject* op, Int32 type, Float* v)
+{
+  GeData data;
+  switch (type)
+  {
+    case Ocube:
+    {
+      op->GetParameter(PRIM_CUBE_LEN, data);
+      Vector size = data.GetVector();
+      v[0] = size.x / 2;
+      v[1] = size.y / 2;
+      v[2] = size.z / 2;
+      return true;
+    }
+
+    case Osphere:
+      op->GetParameter(PRIM_SPHERE_RAD, data);
+      v[0] = data.GetFloat();
+      return true;
+
+    case Ocone:
+      op->GetParameter(PRIM_CONE_TRAD, data);
+      v[0] = data.GetFloat();
+      op->GetParameter(PRIM_CONE_BRAD, data);
+      v[1] = data.GetFloat();
+      op->GetParameter(PRIM_CONE_HEIGHT, data);
+      v[2] = data.GetFloat() / 2;
+      return true;
+
+    case Ocylinder:
+      op->GetParameter(PRIM_CYLINDER_RADIUS, data);
+      v[0] = data.GetFloat();
+      op->GetParameter(PRIM_CYLINDER_HEIGHT, data);
+      v[1] = data.GetFloat() / 2;
+      return true;
+
+    case Oplane:
+      op->GetParameter(PRIM_PLANE_WIDTH, data);
+      v[0] = data.GetFloat() / 2;
+      op->GetParameter(PRIM_PLANE_HEIGHT, data);
+      v[1] = data.GetFloat() / 2;
+      return true;
+
+    case Otorus:
+      op->GetParameter(PRIM_TORUS_OUTERRAD, data);
+      v[0] = data.GetFloat();
+      op->GetParameter(PRIM_TORUS_INNERRAD, data);
+      v[1] = data.GetFloat();
+      return true;
+  }
+  return false;
+}
+
+Bool AlienPrimitiveObjectData::Execute()
+{
+  LogTrace("------------ PRIMITIVE: EXPORT START ----------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^--------- PRIMITIVE: Not exported - Disabled --------^\n");
+      LogTrace("\n^--------- PRIMITIVE: Not exported - Disabled --------^\n");
+      AddNode(NODE_PRIMITIVE, op, ObjectName(op), nullptr, false);  // keeps children in place
       return true;
     }
 
-  Char* objName = op->GetName().GetCStringCopy();
-  if (!objName)
-    objName = String("noname").GetCStringCopy();
-  else
-    MakeValidName(objName);
-
-  printf("\n - AlienPrimitiveObject (%d): %s\n", (int)op->GetType(), objName);
+  const char* objName = ObjectName(op);
+  LogTrace("\n - AlienPrimitiveObject (%d): %s\n", (int)op->GetType(), objName);
   PrintUniqueIDs(this);
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("^------- PRIMITIVE: '%s' Not exported - Render off ----^\n", objName);
-    DeleteMem(objName);
+    LogTrace("^------- PRIMITIVE: '%s' Not exported - Render off ----^\n", objName);
     return true;
   }
 
-  if (exported)
+  PrimitivePayload* prim = g_export->scene.arena.New<PrimitivePayload>();
+  prim->type = this->type_id;
+  if (!PrimitiveValues(op, type_id, prim->v))
   {
-    printf("^------- PRIMITIVE: '%s' Already exported -------------^\n", objName);
-    DeleteMem(objName);
+    LogWarn("^------- PRIMITIVE: '%s' Not exported - Unsupported type ----^\n", objName);
     return true;
   }
-  
-  char declare[MAX_OBJ_NAME] = { 0 };
-  bool at_root = (op->GetUp() == NULL);
-  if (at_root)
-  {
-    sprintf(declare, "#declare %s = ", objName);
-    SaveObject(op);
-  }
-
-  if (this->type_id == Ocube) // Cube
-  {  printf("--------------- CUBE: '%s' EXPORT START ----------------\n", objName);
+  LogTrace("   - Type: %d - Values: %lf, %lf, %lf\n", (int)type_id, prim->v[0], prim->v[1], prim->v[2]);
 
-    op->GetParameter(PRIM_CUBE_LEN, data);
-    Vector size = data.GetVector();
+  SceneNode* node = AddNode(NODE_PRIMITIVE, op, objName, this, true);
+  node->payload = prim;
+  HashValues(node, prim->type, prim->v);
 
-    printf("   - Type: Cube - Size: x=%lf, y=%lf, z=%lf\n", size.x, size.y, size.z);
-    Matrix m = op->GetMg();
-    size.x /= 2;
-    size.y /= 2;
-    size.z /= 2;
-    fprintf(file, "%sbox { <%lf, %lf, %lf>, <%lf, %lf, %lf>\n", declare, -size.x, -size.y, -size.z, size.x, size.y, size.z);
-  } else if (this->type_id == Osphere) { // Sphere
-    printf("--------------- SPHERE: '%s' EXPORT START --------------\n", objName);
-
-    op->GetParameter(PRIM_SPHERE_RAD, data);
-    Float radius = data.GetFloat();
+  PrintMatrix(op->GetMg());
+  PrintUserData(op);
 
-    printf("   - Type: Sphere - Radius = %lf\n", radius);
-    fprintf(file, "%ssphere { 0, %lf \n", declare, radius);
-    
-  } else if (this->type_id == Ocone) { // Cone
-    printf("--------------- CONE: '%s' EXPORT START ----------------\n", objName);
+  LogTrace("^----------- PRIMITIVE: '%s' EXPORT END ---------------^\n", objName);
 
-    op->GetParameter(PRIM_CONE_TRAD, data);
-    Float TopRadius = data.GetFloat();
+  return true;
+}
 
-    op->GetParameter(PRIM_CONE_BRAD, data);
-    Float BottomRadius = data.GetFloat();
+void AlienPrimitiveObjectData::Emit(SceneNode* node)
+{
+  const PrimitivePayload* prim = (const PrimitivePayload*)node->payload;
+  const Float* v = prim->v;
 
-    op->GetParameter(PRIM_CONE_HEIGHT, data);
-    Float Height = data.GetFloat();
+  WriteDeclare(node);
+  switch (prim->type)
+  {
+    case Ocube:
+      WriteString("box { ");
+      WriteParamVec3(node, v, { 0, -1 }, { 1, -1 }, { 2, -1 });
+      WriteString(", ");
+      WriteParamVec3(node, v, { 0, 1 }, { 1, 1 }, { 2, 1 });
+      WriteString("\n");
+      break;
 
-    printf("   - Type: Cone - TopRadius = %lf, BottomRadius = %lf, Height = %lf\n", TopRadius, BottomRadius, Height);
-    Height /= 2;
-    Matrix m = op->GetMg();
-    fprintf(file, "%scone { <%lf, %lf, %lf>, %lf, <%lf, %lf, %lf>, %lf\n",
-      declare, 0, -Height, 0, BottomRadius, 0, Height, 0, TopRadius);
+    case Osphere:
+      WriteString("sphere { 0, ");
+      WriteParam(node, 0, v[0]);
+      WriteString(" \n");
+      break;
 
-  } else if (this->type_id == Ocylinder) { // Cylinder
-    printf("--------------- CYLINDER: '%s' EXPORT START ------------\n", objName);
+    case Ocone:
+      WriteString("cone { ");
+      WriteParamVec3(node, v, { -1, 0 }, { 2, -1 }, { -1, 0 });
+      WriteString(", ");
+      WriteParam(node, 1, v[1]);
+      WriteString(", ");
+      WriteParamVec3(node, v, { -1, 0 }, { 2, 1 }, { -1, 0 });
+      WriteString(", ");
+      WriteParam(node, 0, v[0]);
+      WriteString("\n");
+      break;
 
-    op->GetParameter(PRIM_CYLINDER_RADIUS, data);
-    Float Radius = data.GetFloat();
-    
-    op->GetParameter(PRIM_CYLINDER_HEIGHT, data);
-    Float Height = data.GetFloat();
-    
-    printf("   - Type: Cylinder - Radius = %lf, Height = %lf\n", Radius, Height);
-    Height /= 2;
-    fprintf(file, "%scylinder { <%lf, %lf, %lf>, <%lf, %lf, %lf>, %lf\n",
-      declare, 0, -Height, 0, 0, Height, 0, Radius);
-    
-  } else if (this->type_id == Oplane) { // Plane
-    printf("--------------- PLANE: '%s' EXPORT START ---------------\n", objName);
+    case Ocylinder:
+      WriteString("cylinder { ");
+      WriteParamVec3(node, v, { -1, 0 }, { 1, -1 }, { -1, 0 });
+      WriteString(", ");
+      WriteParamVec3(node, v, { -1, 0 }, { 1, 1 }, { -1, 0 });
+      WriteString(", ");
+      WriteParam(node, 0, v[0]);
+      WriteString("\n");
+      break;
 
-    op->GetParameter(PRIM_PLANE_WIDTH, data);
-    Float width = data.GetFloat();
+    case Oplane:
+      WriteString("plane { <0,1,0> 0\n  bounded_by { box {");
+      WriteParamVec3(node, v, { 0, -1 }, { -1, -0.01 }, { 1, -1 });
+      WriteString(", ");
+      WriteParamVec3(node, v, { 0, 1 }, { -1, 0.01 }, { 1, 1 });
+      WriteString("} }\n  clipped_by { bounded_by }\n");
+      break;
 
-    op->GetParameter(PRIM_PLANE_HEIGHT, data);
-    Float height = data.GetFloat();
+    case Otorus:
+      WriteString("torus { ");
+      WriteParam(node, 0, v[0]);
+      WriteString(", ");
+      WriteParam(node, 1, v[1]);
+      WriteString("\n");
+      break;
+  }
+  WriteClose(node);
+}
 
-    printf("   - Type: Plane - width = %lf, height = %lf\n", width, height);
-    width /= 2;
-    height /= 2;
-    fprintf(file, "%splane { <0,1,0> 0\n  bounded_by { box {<%f, %f, %f>, <%f, %f, %f>} }\n  clipped_by { bounded_by }\n",
-            declare, -width, -0.01, -height, width, 0.01, height);
+bool AlienPrimitiveObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  const PrimitivePayload* prim = (const PrimitivePayload*)node->payload;
+  const Float* v = prim->v;
+  switch (prim->type)
+  {
+    case Ocube:
+      bounds.Add(-v[0], -v[1], -v[2]);
+      bounds.Add(v[0], v[1], v[2]);
+      return true;
 
-  } else if (this->type_id == Otorus) { // Torus
-    printf("--------------- TORUS: '%s' EXPORT START ---------------\n", objName);
+    case Osphere:
+      bounds.Add(-v[0], -v[0], -v[0]);
+      bounds.Add(v[0], v[0], v[0]);
+      return true;
 
-    op->GetParameter(PRIM_TORUS_OUTERRAD, data);
-    Float r_out = data.GetFloat();
+    case Ocone:
+    {
+      double r = max(v[0], v[1]);
+      bounds.Add(-r, -v[2], -r);
+      bounds.Add(r, v[2], r);
+      return true;
+    }
 
-    op->GetParameter(PRIM_TORUS_INNERRAD, data);
-    Float r_in = data.GetFloat();
+    case Ocylinder:
+      bounds.Add(-v[0], -v[1], -v[0]);
+      bounds.Add(v[0], v[1], v[0]);
+      return true;
 
-    printf("   - Type: Torus - Outer radius = %lf, Inner radius = %lf\n", r_out, r_in);
-    fprintf(file, "%storus { %f, %f\n", declare, r_out, r_in);
-  }
+    case Oplane:
+      bounds.Add(-v[0], -0.01, -v[1]);
+      bounds.Add(v[0], 0.01, v[1]);
+      return true;
 
-  if(!at_root)
-  {
-    WriteMatrix(op);
-    WriteMaterial(op);
+    case Otorus:
+      bounds.Add(-(v[0] + v[1]), -v[1], -(v[0] + v[1]));
+      bounds.Add(v[0] + v[1], v[1], v[0] + v[1]);
+      return true;
   }
+  return false;
+}
 
-  // Close object  
-  fprintf(file, "}\n\n");
-
-  PrintMatrix(op->GetMg());
-  PrintUserData(op);
+int AlienPrimitiveObjectData::Animate(SceneNode* node, double* values)
+{
+  const PrimitivePayload* prim = (const PrimitivePayload*)node->payload;
+  return PrimitiveValues((BaseObject*)GetNode(), prim->type, values) ? 3 : 0;
+}
 
-  if (objName)
-    DeleteMem(objName);
-  
-  exported = true;
-  printf("^----------- PRIMITIVE: '%s' EXPORT END ---------------^\n", objName);
+//
+// Light source header: "light_source {<0, 0, 0>\n  rgb<r, g, b> * brightness<flags>"
+//
+static void WriteLightStart(const SceneNode* node, const Vector& color, Float brightness, const char* flags)
+{
+  WriteString("light_source {<0, 0, 0>\n  rgb");
+  WriteVec3(color.x, color.y, color.z);
+  WriteString(" * ");
+  WriteParam(node, 0, brightness);
+  WriteString(flags);
+}
 
-  return true;
+//
+// Light source common tail
+//
+static void WriteLightEnd(Float fade_distance, Float fade_power, const char* projected_through, const char* looks_like)
+{
+  WriteString("  fade_distance ");
+  WriteFloat(fade_distance);
+  WriteString("\n  fade_power ");
+  WriteFloat(fade_power);
+  WriteString("\n  ");
+  WriteString(projected_through);
+  WriteString(looks_like);
+  WriteString("\n");
 }
 
 // 
 // Light
 //
+struct LightPayload
+{
+  Int32 type;
+  Vector color;
+  Float brightness;
+  Float radius;
+  Float falloff;
+  Float tightness;
+  Vector area_axis;
+  Int32 area_num_x;
+  Int32 area_num_y;
+  Float fade_distance;
+  Float fade_power;
+  Float icon_scale;
+  Float icon_tranparency;
+  bool disply_icon;
+  const char* flags;              // shadowless, parallel, media options
+  const char* projected_through;  // statement or ""
+};
+
 Bool AlienLightObjectData::Execute()
 {
-  printf("----------------- LIGHT: EXPORT START -----------------\n");
+  LogTrace("----------------- LIGHT: EXPORT START -----------------\n");
   BaseObject* op = (BaseObject*)GetNode();
 
   GeData data;
   if (op->GetParameter(ID_BASEOBJECT_GENERATOR_FLAG, data))
     if (!data.GetBool())
     {
-      printf("\n^------------- LIGHT: Not exported - Disabled --------^\n");
+      LogTrace("\n^------------- LIGHT: Not exported - Disabled --------^\n");
       return true;
     }
 
   if (op->GetRenderMode() == MODE_OFF)
   {
-    printf("\n^------------- LIGHT: Not exported - Render off ------^\n");
+    LogTrace("\n^------------- LIGHT: Not exported - Render off ------^\n");
     return true;
   }
 
-  Char* pChar = op->GetName().GetCStringCopy();
-  if (pChar)
-  {
-    printf(" - AlienLightObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
-    DeleteMem(pChar);
-  }
-  else
-    printf(" - AlienLightObjectData (%d): <noname>\n", (int)op->GetType());
+  const char* objName = ObjectName(op);
+  LogTrace(" - AlienLightObjectData (%d): \"%s\"\n", (int)op->GetType(), objName);
 
   // General info
   PrintUniqueIDs(this);
   PrintMatrix(op->GetMg());
 
   // Type
-  Int32 type;
+  Int32 type = LIGHT_TYPE_OMNI;
   if (op->GetParameter(LIGHT_TYPE, data) && data.GetType() == DA_LONG)
   {
     type = data.GetInt32();
-    printf(" - Type: (%d)\n", type);
+    LogTrace(" - Type: (%d)\n", type);
   }
   else
-    printf(" - Error getting light type !\n");
+    LogWarn(" - Error getting light type: '%s' !\n", objName);
 
   // Color
   Vector color = Vector(1, 1, 1);
   if (op->GetParameter(LIGHT_COLOR, data) && data.GetType() == DA_VECTOR)
   {
     color = data.GetVector();
-    printf(" - Color: <%f, %f, %f>\n", color.x, color.y, color.z);
+    LogTrace(" - Color: <%f, %f, %f>\n", color.x, color.y, color.z);
   }
   else
-    printf(" - Error getting light color !\n");
+    LogWarn(" - Error getting light color: '%s' !\n", objName);
 
   // Brightness
-  Float brightness;
+  Float brightness = 1;
   if (op->GetParameter(LIGHT_BRIGHTNESS, data) && data.GetType() == DA_REAL)
   {
     brightness = data.GetFloat();
-    printf(" - Brightness: (%f)\n", brightness);
+    LogTrace(" - Brightness: (%f)\n", brightness);
   }
   else
-    printf(" - Error getting light brightness !\n");
+    LogWarn(" - Error getting light brightness: '%s' !\n", objName);
 
   // Shadows
   Int32 shadows = LIGHT_SHADOWTYPE_HARD;
   if (op->GetParameter(LIGHT_SHADOWTYPE, data) && data.GetType() == DA_LONG)
   {
     shadows = data.GetInt32();
-    printf(" - Shadows type : (%f)\n", shadows);
+    LogTrace(" - Shadows type : (%d)\n", shadows);
   }
   else
-    printf(" - Error getting light shadows type !\n");
+    LogWarn(" - Error getting light shadows type: '%s' !\n", objName);
 
   string shadows_str;
   if (shadows == LIGHT_SHADOWTYPE_NONE)
@@ -3908,30 +5636,30 @@ Bool AlienLightObjectData::Execute()
   if (op->GetParameter(LIGHT_DETAILS_INNERANGLE, data) && data.GetType() == DA_REAL)
   {
     radius = RadToDeg(data.GetFloat());
-    printf(" - Radius angle: %f\n", radius);
+    LogTrace(" - Radius angle: %f\n", radius);
   }
   else
-    printf(" - Error getting light radius !\n");
+    LogWarn(" - Error getting light radius: '%s' !\n", objName);
 
   // Falloff
   Float falloff = 0;
   if (op->GetParameter(LIGHT_DETAILS_OUTERANGLE, data) && data.GetType() == DA_REAL)
   {
     falloff = RadToDeg(data.GetFloat());
-    printf(" - Falloff angle: %f\n", falloff);
+    LogTrace(" - Falloff angle: %f\n", falloff);
   }
   else
-    printf(" - Error getting light falloff angle !\n");
+    LogWarn(" - Error getting light falloff angle: '%s' !\n", objName);
 
   // Use inner cone
   bool use_inner = 0;
   if (op->GetParameter(LIGHT_DETAILS_INNERCONE, data))
   {
     use_inner = data.GetBool();
-    printf(" - Use inner: %d\n", use_inner);
+    LogTrace(" - Use inner: %d\n", use_inner);
   }
   else
-    printf(" - Error getting light 'use inner' option !\n");
+    LogWarn(" - Error getting light 'use inner' option: '%s' !\n", objName);
 
   if (!use_inner)
     radius = falloff;
@@ -3941,18 +5669,18 @@ Bool AlienLightObjectData::Execute()
   if (op->GetParameter(LIGHT_AREADETAILS_SIZEX, data) && data.GetType() == DA_REAL)
   {
     area_axis.x = data.GetFloat();
-    printf(" - Area X: %f\n", area_axis.x);
+    LogTrace(" - Area X: %f\n", area_axis.x);
   }
   else
-    printf(" - Error getting light area_axis !\n");
+    LogWarn(" - Error getting light area_axis: '%s' !\n", objName);
 
   if (op->GetParameter(LIGHT_AREADETAILS_SIZEY, data) && data.GetType() == DA_REAL)
   {
     area_axis.y = data.GetFloat();
-    printf(" - Area Y: %f\n", area_axis.y);
+    LogTrace(" - Area Y: %f\n", area_axis.y);
   }
   else
-    printf(" - Error getting light area_axis !\n");
+    LogWarn(" - Error getting light area_axis: '%s' !\n", objName);
 
   //
   // Get params from tag
@@ -3978,34 +5706,60 @@ Bool AlienLightObjectData::Execute()
                disply_icon, parallel,
                media_attenuation, media_interaction );
 
-  if (disply_icon)
-  {
-    fprintf(file, "#declare Lightsource_Shape_Tex =\n\
-    texture { pigment{ rgbt <%0.2f, %0.2f, %0.2f, %0.2f>}\n\
-      finish { phong 1 reflection {0.1 metallic 0.2}}}\n\n", 1.0, 1.0, 1.0, icon_tranparency);
-  }
+  const char* parallel_str = parallel ? " parallel" : "";
+  const char* media_attenuation_str = media_attenuation ? " media_attenuation on" : "";
+  const char* media_interaction_str = media_interaction ? "" : " media_interaction off";
 
-  char parallel_str[MAX_OBJ_NAME] = { 0 };
-  if (parallel)
+  if (projected_through != "")
   {
-    sprintf(parallel_str, " parallel");
+    projected_through = "projected_through { " + projected_through +  " }\n";
   }
 
-  char media_attenuation_str[MAX_OBJ_NAME] = { 0 };
-  if (media_attenuation)
-  {
-    sprintf(media_attenuation_str, " media_attenuation on");
-  }
+  LightPayload* lp = g_export->scene.arena.New<LightPayload>();
+  lp->type = type;
+  lp->color = color;
+  lp->brightness = brightness;
+  lp->radius = radius;
+  lp->falloff = falloff;
+  lp->tightness = tightness;
+  lp->area_axis = area_axis;
+  lp->area_num_x = area_num_x;
+  lp->area_num_y = area_num_y;
+  lp->fade_distance = fade_distance;
+  lp->fade_power = fade_power;
+  lp->icon_scale = icon_scale;
+  lp->icon_tranparency = icon_tranparency;
+  lp->disply_icon = disply_icon;
+  lp->flags = g_export->scene.Intern(shadows_str + parallel_str + media_interaction_str + media_attenuation_str);
+  lp->projected_through = g_export->scene.Intern(projected_through);
+
+  SceneNode* node = AddNode(NODE_LIGHT, op, objName, this, false);
+  node->payload = lp;
+  HashValues(node, lp->type, lp->color, lp->brightness, lp->radius, lp->falloff, lp->tightness,
+             lp->area_axis, lp->area_num_x, lp->area_num_y, lp->fade_distance, lp->fade_power,
+             lp->icon_scale, lp->icon_tranparency, lp->disply_icon);
+  HashNode(node, lp->flags);
+  HashNode(node, lp->projected_through);
+
+  LogTrace("^---------------- LIGHT: EXPORT END ------------------^\n");
+  return true;
+}
 
-  char media_interaction_str[MAX_OBJ_NAME] = { 0 };
-  if (!media_interaction)
-  {
-    sprintf(media_interaction_str, " media_interaction off");
-  }
+void AlienLightObjectData::Emit(SceneNode* node)
+{
+  const LightPayload* lp = (const LightPayload*)node->payload;
+  Int32 type = lp->type;
+  bool disply_icon = lp->disply_icon;
+  Float icon_scale = lp->icon_scale;
+  const char* flags = lp->flags;
 
-  if (projected_through != "")
+  if (disply_icon)
   {
-    projected_through = "projected_through { " + projected_through +  " }\n";
+    WriteString("#declare Lightsource_Shape_Tex =\n\
+    texture { pigment{ rgbt <1, 1, 1, ");
+    WriteFloat(lp->icon_tranparency, g_iconFormat);
+    WriteString(">}\n\
+      finish { phong 1 reflection {0.1 metallic 0.2}}}\n\n");
   }
 
   //
@@ -4014,14 +5768,14 @@ Bool AlienLightObjectData::Execute()
   // fprintf(o.fh,'#declare Cylinder_Shape = union { sphere { <0, 0, 0>, 0.25 } cylinder { <0,0,0>,<%0.2f, %0.2f, %0.2f>,0.15 } texture {Lightsource_Shape_Tex}}\n', ...
   //
 
-  char looks_like[MAX_OBJ_NAME] = { 0 };
+  const char* looks_like = "";
 
   if (type == LIGHT_TYPE_OMNI)
   {
     if (disply_icon)
     {
       // Icon
-      fprintf(file, "#declare Pointlight_Shape =\n\
+      WriteString("#declare Pointlight_Shape =\n\
   union {sphere { <0, 0, 0>, 0.25 }\n\
         cone { <0, 0, 0>, 0.15, <0.6,  0, 0>,0 }\n\
         cone { <0, 0, 0>, 0.15, <-0.6, 0, 0>,0 }\n\
@@ -4030,76 +5784,123 @@ Bool AlienLightObjectData::Execute()
         cone { <0, 0, 0>, 0.15, <0,  0, 0.6>,0 }\n\
         cone { <0, 0, 0>, 0.15, <0,  0,-0.6>,0 }\n\
         texture { Lightsource_Shape_Tex }\n\
-        scale %0.2f}\n\n", icon_scale);
+        scale ");
+      WriteFloat(icon_scale, g_iconFormat);
+      WriteString("}\n\n");
 
-      sprintf(looks_like, "looks_like {Pointlight_Shape}");
+      looks_like = "looks_like {Pointlight_Shape}";
     }
 
     // Light
-    fprintf(file, "light_source {<0, 0, 0>\n\
-  rgb<%f, %f, %f> * %f%s%s%s%s\n\
-  fade_distance %f\n\
-  fade_power %f\n\
-  %s%s\n",
-    color.x, color.y, color.z, brightness, shadows_str.c_str(), parallel_str, media_interaction_str, media_attenuation_str, fade_distance, fade_power, projected_through.c_str(), looks_like);
+    WriteLightStart(node, lp->color, lp->brightness, flags);
+    WriteString("\n");
+    WriteLightEnd(lp->fade_distance, lp->fade_power, lp->projected_through, looks_like);
 
   } else if (type == LIGHT_TYPE_SPOT)
   {
     // Icon
     if (disply_icon)
     {
-      fprintf(file, "#declare Spotlight_Shape =\n\
+      WriteString("#declare Spotlight_Shape =\n\
   union { sphere { <0, 0, 0>, 0.1 }\n\
     cone { <0,0,0>,0,<0, 0, 1.5>, 0.3 }\n\
     texture {Lightsource_Shape_Tex}\n\
-    scale %0.2f}\n\n", icon_scale);
+    scale ");
+      WriteFloat(icon_scale, g_iconFormat);
+      WriteString("}\n\n");
 
-      sprintf(looks_like, "looks_like {Spotlight_Shape}");
+      looks_like = "looks_like {Spotlight_Shape}";
     }
 
     // Light
-    fprintf(file, "light_source {<0, 0, 0>\n\
-  rgb<%f, %f, %f> * %f%s%s%s%s spotlight\n\
-  radius %f\n\
-  falloff %f\n\
-  tightness %f\n\
-  fade_distance %f\n\
-  fade_power %f\n\
-  %s%s\n",
-      color.x, color.y, color.z, brightness, shadows_str.c_str(), parallel_str, media_interaction_str, media_attenuation_str, radius, falloff, tightness, fade_distance, fade_power, projected_through.c_str(), looks_like);
+    WriteLightStart(node, lp->color, lp->brightness, flags);
+    WriteString(" spotlight\n  radius ");
+    WriteFloat(lp->radius);
+    WriteString("\n  falloff ");
+    WriteFloat(lp->falloff);
+    WriteString("\n  tightness ");
+    WriteFloat(lp->tightness);
+    WriteString("\n");
+    WriteLightEnd(lp->fade_distance, lp->fade_power, lp->projected_through, looks_like);
 
   } else if (type == LIGHT_TYPE_AREA)
   {
     // Icon
     if (disply_icon)
     {
-      fprintf(file, "#declare Area_Shape =\n\
+      WriteString("#declare Area_Shape =\n\
   union {\n\
     plane { <0,0,1>, 0 clipped_by {box {<-0.5,-0.5,-0.5>, <0.5,0.5,0.5>}}}\n\
     cylinder { <0,0,0>, <0,0,0.8>, 0.05 } cone { <0,0,0.6>,0.1,<0,0,1>, 0 }\n\
     texture {Lightsource_Shape_Tex}\n\
-    scale %0.2f}\n\n", icon_scale);
+    scale ");
+      WriteFloat(icon_scale, g_iconFormat);
+      WriteString("}\n\n");
 
-      sprintf(looks_like, "looks_like {Area_Shape}");
+      looks_like = "looks_like {Area_Shape}";
     }
 
     // Light
-    fprintf(file, "light_source {<0, 0, 0>\n\
-  rgb<%f, %f, %f> * %f%s%s%s%s\n\
-  area_light <%f, 0, 0>, <0, %f, 0>, %d, %d\n\
-  fade_distance %f\n\
-  fade_power %f\n\
-  %s%s\n",
-    color.x, color.y, color.z, brightness, shadows_str.c_str(), parallel_str, media_interaction_str, media_attenuation_str, area_axis.x, area_axis.y, area_num_x, area_num_y, fade_distance, fade_power, projected_through.c_str(), looks_like);
-  }
+    WriteLightStart(node, lp->color, lp->brightness, flags);
+    WriteString("\n  area_light ");
+    WriteVec3(lp->area_axis.x, 0, 0);
+    WriteString(", ");
+    WriteVec3(0, lp->area_axis.y, 0);
+    WriteString(", ");
+    WriteInt(lp->area_num_x);
+    WriteString(", ");
+    WriteInt(lp->area_num_y);
+    WriteString("\n");
+    WriteLightEnd(lp->fade_distance, lp->fade_power, lp->projected_through, looks_like);
+  }
+
+  WriteMatrix(node);
+  WriteString("}\n\n");
+}
 
-  WriteMatrix(op);
-  fprintf(file, "}\n\n");
+//
+// Box of the looks_like icon, empty for lights without one
+//
+bool AlienLightObjectData::Bound(const SceneNode* node, Bounds& bounds)
+{
+  const LightPayload* lp = (const LightPayload*)node->payload;
+  if (!lp->disply_icon)
+    return true;
 
-  printf("^---------------- LIGHT: EXPORT END ------------------^\n");
+  // Icon shapes as declared by Emit(), scaled as written
+  Bounds icon;
+  if (lp->type == LIGHT_TYPE_OMNI)
+  {
+    icon.Add(-0.6, -0.6, -0.6);
+    icon.Add(0.6, 0.6, 0.6);
+  }
+  else if (lp->type == LIGHT_TYPE_SPOT)
+  {
+    icon.Add(-0.3, -0.3, -0.1);
+    icon.Add(0.3, 0.3, 1.5);
+  }
+  else if (lp->type == LIGHT_TYPE_AREA)
+  {
+    icon.Add(-0.5, -0.5, 0.0);
+    icon.Add(0.5, 0.5, 1.0);
+  }
+
+  char buf[64];
+  *FormatFloat(buf, lp->icon_scale, g_iconFormat) = 0;
+  double scale = strtod(buf, nullptr);
+  const double m[12] = { scale, 0, 0, 0, scale, 0, 0, 0, scale, 0, 0, 0 };
+  bounds.Add(icon.Transformed(m));
   return true;
 }
 
+int AlienLightObjectData::Animate(SceneNode* node, double* values)
+{
+  GeData data;
+  BaseObject* op = (BaseObject*)GetNode();
+  values[0] = op->GetParameter(LIGHT_BRIGHTNESS, data) && data.GetType() == DA_REAL ? data.GetFloat() : 1;
+  return 1;
+}
+
 // Execute function for LOD objects
 Bool AlienLodObjectData::Execute()
 {
@@ -4107,11 +5908,11 @@ Bool AlienLodObjectData::Execute()
   Char *pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienLodObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienLodObjectData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienLodObjectData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienLodObjectData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
@@ -4129,26 +5930,26 @@ Bool AlienLodObjectData::Execute()
   Int32 lodMode = op->GetDataInstance()->GetInt32(LOD_MODE);
   Int32 lodCriteria = op->GetDataInstance()->GetInt32(LOD_CRITERIA);
   Int32 levelCnt = GetLevelCount();
-  printf("\n   - Mode         : %d\n", lodMode);
-  printf("   - Criteria     : %d\n", lodCriteria);
-  printf("   - Level Count  : %d\n", levelCnt);
-  printf("   - Current Level: %d\n", GetCurrentLevel());
+  LogTrace("\n   - Mode         : %d\n", lodMode);
+  LogTrace("   - Criteria     : %d\n", lodCriteria);
+  LogTrace("   - Level Count  : %d\n", levelCnt);
+  LogTrace("   - Current Level: %d\n", GetCurrentLevel());
 
   RangeData* lodRange = (RangeData*)op->GetDataInstance()->GetCustomDataType(LOD_BAR, CUSTOMDATATYPE_RANGE);
   if (lodRange)
   {
-    printf("\n -   Ranges:\n");
+    LogTrace("\n -   Ranges:\n");
     for (Int32 k = 0; k <= lodRange->GetKnotsCount(); k++)
     {
       Vector col = lodRange->GetRangeColor(k);
       Float value1 = k == 0 ? 0.0 : lodRange->GetKnotValue(k - 1);
       Float value2 = k < lodRange->GetKnotsCount() ? lodRange->GetKnotValue(k) : 1.0;
-      printf("     -> Range %d - Value: %f to %f - Color: %d %d %d\n", k, minDis + value1 * (maxDis - minDis), minDis + value2 * (maxDis - minDis), Int32(col.x * 255.0), Int32(col.y * 255.0), Int32(col.z * 255.0));
+      LogTrace("     -> Range %d - Value: %f to %f - Color: %d %d %d\n", k, minDis + value1 * (maxDis - minDis), minDis + value2 * (maxDis - minDis), Int32(col.x * 255.0), Int32(col.y * 255.0), Int32(col.z * 255.0));
     }
   }
   else
   {
-    printf("\n -   Error getting LOD ranges !\n");
+    LogTrace("\n -   Error getting LOD ranges !\n");
   }
 
   PrintUserData(op);
@@ -4163,24 +5964,27 @@ Bool AlienVolumeBuilderData::Execute()
   Char*        pChar = op->GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienVolumeBuilderData (%d): \"%s\"\n", (int)op->GetType(), pChar);
+    LogTrace("\n - AlienVolumeBuilderData (%d): \"%s\"\n", (int)op->GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienVolumeBuilderData (%d): <noname>\n", (int)op->GetType());
+    LogTrace("\n - AlienVolumeBuilderData (%d): <noname>\n", (int)op->GetType());
 
   PrintUniqueIDs(this);
 
   PrintMatrix(op->GetMg());
 
   Int32 volMode = op->GetDataInstanceRef().GetInt32(ID_VOLUMEBUILDER_VOLUMETYPE);
-  printf("\n -   Volume Mode: %d\n", volMode);
+  LogTrace("\n -   Volume Mode: %d\n", volMode);
 
   return true;
 }
 
 static void PrintMateriaCache(BaseContainer& bc)
 {
+  if (!LogEnabled(LOG_TRACE))
+    return;
+
   BrowseContainer browse(&bc);
   Int32 paramId;
   GeData* contData;
@@ -4193,7 +5997,7 @@ static void PrintMateriaCache(BaseContainer& bc)
       if (!subBc)
         continue;
 
-      printf("   - (%d) ", paramId);
+      LogTrace("   - (%d) ", paramId);
 
       BrowseContainer subBrowse(subBc);
       Int32 subParamId;
@@ -4206,7 +6010,7 @@ static void PrintMateriaCache(BaseContainer& bc)
           Char* name = data->GetString().GetCStringCopy();
           if (name)
           {
-            printf("\"%s\"  ", name);
+            LogTrace("\"%s\"  ", name);
             DeleteMem(name);
           }
         }
@@ -4214,26 +6018,26 @@ static void PrintMateriaCache(BaseContainer& bc)
         {
           if (data->GetType() == DA_LONG)
           {
-            printf("Int: %d  ", data->GetInt32());
+            LogTrace("Int: %d  ", data->GetInt32());
           }
           else if (data->GetType() == DA_LLONG)
           {
-            printf("Int64: %d  ", data->GetInt64());
+            LogTrace("Int64: %d  ", data->GetInt64());
           }
           else if (data->GetType() == DA_REAL)
           {
-            printf("Float: %f  ", data->GetFloat());
+            LogTrace("Float: %f  ", data->GetFloat());
           }
           else if (data->GetType() == DA_VECTOR)
           {
-            printf("Vector: %f %f %f  ", data->GetVector().x, data->GetVector().y, data->GetVector().z);
+            LogTrace("Vector: %f %f %f  ", data->GetVector().x, data->GetVector().y, data->GetVector().z);
           }
           else if (data->GetType() == DA_STRING)
           {
             Char* str = data->GetString().GetCStringCopy();
             if (str)
             {
-              printf("String: %s  ", str);
+              LogTrace("String: %s  ", str);
               DeleteMem(str);
             }
           }
@@ -4241,14 +6045,14 @@ static void PrintMateriaCache(BaseContainer& bc)
           {
             Char* fn = data->GetFilename().GetString().GetCStringCopy();
             {
-              printf("Filename: %s  ", fn);
+              LogTrace("Filename: %s  ", fn);
               DeleteMem(fn);
             }
           }
         }
       }
 
-      printf("\n");
+      LogTrace("\n");
     }
   }
 }
@@ -4259,18 +6063,16 @@ Bool AlienMaterial::Execute()
   Char* pChar = GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienMaterial (%d): %s\n", (int)GetType(), pChar);
+    LogTrace("\n - AlienMaterial (%d): %s\n", (int)GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienMaterial (%d): <noname>\n", (int)GetType());
+    LogTrace("\n - AlienMaterial (%d): <noname>\n", (int)GetType());
 
   PrintUniqueIDs(this);
 
   // assign a id to the material
-  matId = g_tempmatid;
-
-  g_tempmatid++;
+  matId = g_export->matId++;
 
   // material preview custom data type
   GeData mData;
@@ -4281,7 +6083,7 @@ Bool AlienMaterial::Execute()
     {
       MatPreviewType mPreviewType = mPreview->GetPreviewType();
       MatPreviewSize mPreviewSize = mPreview->GetPreviewSize();
-      printf("   MaterialPreview: Type:%d Size:%d\n", mPreviewType, mPreviewSize);
+      LogTrace("   MaterialPreview: Type:%d Size:%d\n", mPreviewType, mPreviewSize);
     }
   }
 
@@ -4297,12 +6099,12 @@ Bool AlienMaterial::Execute()
       Char* refName = refLay->GetName().GetCStringCopy();
       Int32 dataId = refLay->GetDataID();
       Int32 refType = reflectanceData->GetInt32(dataId + REFLECTION_LAYER_MAIN_DISTRIBUTION);
-      printf(" - reflectance layer '%s' of type: %d\n", refName, refType);
+      LogTrace(" - reflectance layer '%s' of type: %d\n", refName, refType);
       DeleteMem(refName);
     }
   }
 
-  printf("   Material Cache (Standard Surface Properties):\n");
+  LogTrace("   Material Cache (Standard Surface Properties):\n");
   PrintMateriaCache(GetMaterialCache());
 
   PrintAnimInfo(this);
@@ -4316,66 +6118,64 @@ Bool AlienBaseMaterial::Execute()
   Char *pChar = GetName().GetCStringCopy();
   if (pChar)
   {
-    printf("\n - AlienPluginMaterial (%d): %s\n", (int)GetType(), pChar);
+    LogTrace("\n - AlienPluginMaterial (%d): %s\n", (int)GetType(), pChar);
     DeleteMem(pChar);
   }
   else
-    printf("\n - AlienPluginMaterial (%d): <noname>\n", (int)GetType());
+    LogTrace("\n - AlienPluginMaterial (%d): <noname>\n", (int)GetType());
 
   PrintUniqueIDs(this);
 
   // assign a id to the material
-  matId = g_tempmatid;
-
-  g_tempmatid++;
+  matId = g_export->matId++;
 
   switch(GetType())
   {
     case Mmaterial:
-      printf("   Cinema Material\n");
+      LogTrace("   Cinema Material\n");
       break;
     case Msketch:
-      printf("   Sketch & Toon Material\n");
+      LogTrace("   Sketch & Toon Material\n");
       break;
     case Mdanel:
-      printf("   Daniel Shader Material\n");
+      LogTrace("   Daniel Shader Material\n");
       break;
     case Mbanji:
-      printf("   Banji Shader Material\n");
+      LogTrace("   Banji Shader Material\n");
       break;
     case Mbanzi:
-      printf("   Banzi Shader Material\n");
+      LogTrace("   Banzi Shader Material\n");
       break;
     case Mcheen:
-      printf("   Cheen Shader Material\n");
+      LogTrace("   Cheen Shader Material\n");
       break;
     case Mmabel:
-      printf("   Mabel Shader Material\n");
+      LogTrace("   Mabel Shader Material\n");
       break;
     case Mnukei:
-      printf("   Nukei Shader Material\n");
+      LogTrace("   Nukei Shader Material\n");
       break;
     case Xskyshader:
-      printf("   Sky Material (hidden)\n");
+      LogTrace("   Sky Material (hidden)\n");
       break;
     case Mfog:
-      printf("   Fog Shader Material\n");
+      LogTrace("   Fog Shader Material\n");
       break;
     case Mterrain:
-      printf("   Terrain Shader Material\n");
+      LogTrace("   Terrain Shader Material\n");
       break;
     case Mhair:
-      printf("   Hair Shader Material\n");
+      LogTrace("   Hair Shader Material\n");
       break;
     case Marchigrass:
-      printf("   ArchiGrass Material\n");
+      LogTrace("   ArchiGrass Material\n");
       {
         const GeData &shader = GetDataInstance()->GetData(GRASS_DENSITY_SHD);
         PrintShaderInfo((BaseShader*)shader.GetLink(), 4);
       }
       break;
     default:
-      printf("   unknown plugin material\n");
+      LogTrace("   unknown plugin material\n");
   }
 
   return true;
@@ -4736,11 +6536,269 @@ Bool BaseDocument::CreateSceneToC4D(Bool selectedonly)
   if (!BuildObjectsToC4D(g_myInternalDoc->GetFirstObject(), nullptr, this))
     return false;
 
-  printf("\n scene build was successful\n");
+  LogTrace("\n scene build was successful\n");
 
   return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Synthetic benchmark scenes
+//
+// --generate writes a .c4d document with parameterized object counts,
+// built with the same SDK calls as the export example above. Meshes
+// differ in shape, so mesh instancing doesn't collapse them.
+//////////////////////////////////////////////////////////////////////////
+
+struct GeneratorSpec
+{
+  Int32 meshes = 0;      // polygon objects
+  Int32 polys = 100;     // quads per mesh
+  Int32 depth = 0;       // nested Null/Boole levels
+  Int32 splines = 0;     // sweeps along a spline path
+  Int32 points = 64;     // points per path
+  Int32 lights = 0;
+  Int32 materials = 8;   // assigned to meshes in turn
+};
+
+//
+// "key=value,key=value..." with keys meshes, polys, depth, splines,
+// points, lights, materials. Returns false on unknown keys or bad values.
+//
+static bool ParseGeneratorSpec(const char* str, GeneratorSpec& spec)
+{
+  struct Key { const char* name; Int32* value; Int32 min; };
+  const Key keys[] = {
+    { "meshes", &spec.meshes, 0 }, { "polys", &spec.polys, 1 },
+    { "depth", &spec.depth, 0 }, { "splines", &spec.splines, 0 },
+    { "points", &spec.points, 2 }, { "lights", &spec.lights, 0 },
+    { "materials", &spec.materials, 1 },
+  };
+
+  string s(str);
+  size_t pos = 0;
+  while (pos < s.size())
+  {
+    size_t end = s.find(',', pos);
+    if (end == string::npos)
+      end = s.size();
+    string item = s.substr(pos, end - pos);
+    pos = end + 1;
+
+    size_t eq = item.find('=');
+    if (eq == string::npos)
+      return false;
+    string name = item.substr(0, eq);
+    char* last = nullptr;
+    long value = strtol(item.c_str() + eq + 1, &last, 10);
+    if (*last || last == item.c_str() + eq + 1)
+      return false;
+
+    const Key* key = nullptr;
+    for (const Key& k : keys)
+      if (name == k.name)
+        key = &k;
+    if (!key || value < key->min || value > 100000000)
+      return false;
+    *key->value = (Int32)value;
+  }
+  return true;
+}
+
+static BaseObject* InsertGenerated(BaseDocument* doc, BaseObject* op, const char* name, const Vector& pos, BaseObject* parent, BaseObject* pred)
+{
+  if (!op)
+    return nullptr;
+  Matrix m;
+  m.off = pos;
+  op->SetMl(m);
+  op->SetName(name);
+  doc->InsertObject(op, parent, pred);
+  return op;
+}
+
+static bool AssignMaterial(BaseObject* op, BaseMaterial* mat)
+{
+  TextureTag* tag = NewObj(TextureTag);
+  if (!tag)
+    return false;
+  op->InsertTag(tag);
+
+  BaseLink link;
+  link.SetLink(mat);
+  tag->SetParameter(TEXTURETAG_MATERIAL, link);
+  return true;
+}
+
+//
+// Wavy grid of about 'polys' quads, shape varies with 'seed'
+//
+static BaseObject* GenerateMesh(Int32 polys, Int32 seed)
+{
+  Int32 cols = (Int32)ceil(sqrt((double)polys));
+  Int32 rows = (polys + cols - 1) / cols;
+
+  PolygonObject* op = (PolygonObject*)BaseObject::Alloc(Opolygon);
+  if (!op || !op->ResizeObject((cols + 1) * (rows + 1), cols * rows, 0))
+  {
+    BaseObject::Free((BaseObject*&)op);
+    return nullptr;
+  }
+
+  Vector* p = op->GetPointW();
+  double phase = seed * 0.7;
+  for (Int32 r = 0; r <= rows; r++)
+    for (Int32 c = 0; c <= cols; c++)
+    {
+      double x = (double)c / cols - 0.5;
+      double z = (double)r / rows - 0.5;
+      p[r * (cols + 1) + c] = Vector(x * 100, 10 * sin(x * 9 + phase) * cos(z * 7 + phase), z * 100);
+    }
+
+  CPolygon* v = op->GetPolygonW();
+  for (Int32 r = 0; r < rows; r++)
+    for (Int32 c = 0; c < cols; c++)
+    {
+      Int32 a = r * (cols + 1) + c;
+      v[r * cols + c] = CPolygon(a, a + cols + 1, a + cols + 2, a + 1);
+    }
+  return op;
+}
+
+//
+// Sweep of a circle along a helix path with 'points' points
+//
+static BaseObject* GenerateSweep(BaseDocument* doc, Int32 points, Int32 seed, const Vector& pos, BaseObject* pred)
+{
+  string name = "Sweep_" + to_string(seed);
+  BaseObject* sweep = InsertGenerated(doc, BaseObject::Alloc(Osweep), name.c_str(), pos, nullptr, pred);
+  if (!sweep)
+    return nullptr;
+
+  BaseObject* profile = InsertGenerated(doc, BaseObject::Alloc(Osplinecircle), "Profile", Vector(), sweep, nullptr);
+  if (profile)
+    profile->SetParameter(PRIM_CIRCLE_RADIUS, GeData(2.0 + seed % 3));
+
+  SplineObject* path = (SplineObject*)BaseObject::Alloc(Ospline);
+  if (!path || !path->ResizeObject(points, 0))
+  {
+    BaseObject::Free((BaseObject*&)path);
+    return sweep;
+  }
+  path->SetParameter(SPLINEOBJECT_TYPE, SPLINEOBJECT_TYPE_LINEAR);
+
+  Vector* p = path->GetPointW();
+  double turns = 2.0 + seed % 4;
+  for (Int32 i = 0; i < points; i++)
+  {
+    double t = (double)i / (points - 1);
+    double a = t * turns * 2 * PI;
+    p[i] = Vector(30 * cos(a), 100 * t, 30 * sin(a));
+  }
+  InsertGenerated(doc, path, "Path", Vector(), sweep, profile);
+  return sweep;
+}
+
+//
+// Write synthetic scene 'fn', returns false if it failed
+//
+static bool GenerateScene(const char* fn, const GeneratorSpec& spec)
+{
+  BaseDocument* doc = BaseDocument::Alloc();
+  if (!doc)
+    return false;
+
+  // Root objects are inserted after 'last', in document order
+  BaseObject* last = InsertGenerated(doc, BaseObject::Alloc(Ocamera), "Camera", Vector(0, 400, -1200), nullptr, nullptr);
+
+  vector<BaseMaterial*> materials;
+  for (Int32 i = 0; i < spec.materials && spec.meshes > 0; i++)
+  {
+    AlienMaterial* mat = NewObj(AlienMaterial);
+    if (!mat)
+      break;
+    mat->SetName(("Material_" + to_string(i)).c_str());
+    mat->SetParameter(MATERIAL_COLOR_COLOR, Vector(0.2 + 0.1 * (i % 8), 0.5, 0.9 - 0.1 * (i % 8)));
+    doc->InsertMaterial(mat);
+    materials.push_back(mat);
+  }
+
+  Int32 side = (Int32)ceil(sqrt((double)max(spec.meshes, spec.splines)));
+  for (Int32 i = 0; i < spec.meshes; i++)
+  {
+    string name = "Mesh_" + to_string(i);
+    Vector pos(120.0 * (i % side), 0, 120.0 * (i / side));
+    BaseObject* op = InsertGenerated(doc, GenerateMesh(spec.polys, i), name.c_str(), pos, nullptr, last);
+    if (!op)
+      break;
+    if (!materials.empty())
+      AssignMaterial(op, materials[i % materials.size()]);
+    last = op;
+  }
+
+  for (Int32 i = 0; i < spec.splines; i++)
+  {
+    Vector pos(120.0 * (i % side), 200, 120.0 * (i / side));
+    BaseObject* op = GenerateSweep(doc, spec.points, i, pos, last);
+    if (!op)
+      break;
+    last = op;
+  }
+
+  // Nested groups, Null and union Boole in turn, each holding a sphere
+  // and the next level
+  BaseObject* parent = nullptr;
+  BaseObject* pred = last;
+  for (Int32 level = 0; level < spec.depth; level++)
+  {
+    string name = "Level_" + to_string(level);
+    bool boole = level % 2 == 1;
+    BaseObject* group = InsertGenerated(doc, BaseObject::Alloc(boole ? Oboole : Onull), name.c_str(), Vector(10, 0, 0), parent, pred);
+    if (!group)
+      break;
+    if (boole)
+      group->SetParameter(BOOLEOBJECT_TYPE, BOOLEOBJECT_TYPE_UNION);
+    if (!parent)
+      last = group;
+
+    name = "Ball_" + to_string(level);
+    BaseObject* ball = InsertGenerated(doc, BaseObject::Alloc(Osphere), name.c_str(), Vector(0, 8, 0), group, nullptr);
+    if (ball)
+      ball->SetParameter(PRIM_SPHERE_RAD, GeData(10.0));
+    parent = group;
+    pred = ball;
+  }
+
+  for (Int32 i = 0; i < spec.lights; i++)
+  {
+    string name = "Light_" + to_string(i);
+    double a = 2 * PI * i / spec.lights;
+    BaseObject* op = InsertGenerated(doc, BaseObject::Alloc(Olight), name.c_str(), Vector(800 * cos(a), 600, 800 * sin(a)), nullptr, last);
+    if (!op)
+      break;
+    op->SetParameter(LIGHT_TYPE, LIGHT_TYPE_OMNI);
+    op->SetParameter(LIGHT_COLOR, Vector(1, 1, 1));
+    op->SetParameter(LIGHT_BRIGHTNESS, GeData(1.0 / spec.lights));
+    last = op;
+  }
+
+  HyperFile* file = NewObj(HyperFile);
+  bool ok = file && file->Open(DOC_IDENT, fn, FILEOPEN_WRITE);
+  if (ok)
+  {
+    ok = doc->Write(file);
+    file->Close();
+  }
+  DeleteObj(file);
+  BaseDocument::Free(doc);
+
+  if (ok)
+    LogInfo(" # Generated: %s - %d meshes x %d quads, %d sweeps x %d points, depth %d, %d lights\n",
+            fn, (int)spec.meshes, (int)spec.polys, (int)spec.splines, (int)spec.points, (int)spec.depth, (int)spec.lights);
+  else
+    LogError("\n # Can't write scene: %s\n", fn);
+  return ok;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // MAIN FUNCTION
 //////////////////////////////////////////////////////////////////////////
@@ -4749,6 +6807,482 @@ Bool BaseDocument::CreateSceneToC4D(Bool selectedonly)
 #include <uuid/uuid.h>
 #endif
 
+//
+// Command line options besides the export globals
+//
+struct CommandLine
+{
+  const char* fnLoad = nullptr;
+  const char* fnSave = nullptr;
+  size_t bufferSize = OutputSink::DEFAULT_BUFFER_SIZE;
+  bool asyncIO = false;
+  bool useCache = false;
+  bool animation = false;
+  bool threadsSet = false;
+  bool logLevelSet = false;
+
+  // Batch mode: files, patterns and @manifests
+  bool batch = false;
+  vector<const char*> inputs;
+  const char* outDir = nullptr;
+  unsigned jobs = 1;
+  vector<const char*> workerArgs;    // options passed on to worker processes
+  const char* batchStatus = nullptr; // worker process: status file of its jobs
+
+  // Watch mode
+  const char* watchDir = nullptr;
+  int debounceMs = 500;
+
+  // Write a synthetic scene instead of exporting
+  bool generate = false;
+  GeneratorSpec scene;
+};
+
+//
+// Option value as number, false unless the whole string is one
+//
+static bool ParseNumber(const char* s, int& v)
+{
+  char* end;
+  long n = strtol(s, &end, 10);
+  if (end == s || *end || n < INT_MIN || n > INT_MAX)
+    return false;
+  v = (int)n;
+  return true;
+}
+
+static bool ParseNumber(const char* s, double& v)
+{
+  char* end;
+  v = strtod(s, &end);
+  return end != s && !*end && isfinite(v);
+}
+
+//
+// Parse command line: [options] <infile.c4d> <outfile.inc>
+//                     --batch [options] <inputs ...>
+//                     --watch <dir> [options]
+//                     --generate <spec> <outfile.c4d>
+//
+static bool ParseArgs(int argc, Char* argv[], CommandLine& cl)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--", 2) != 0)
+    {
+      cl.inputs.push_back(arg);
+      continue;
+    }
+
+    // Batch workers get the export options, jobs come by manifest
+    bool forward = strcmp(arg, "--batch") && strcmp(arg, "--jobs") && strcmp(arg, "--out-dir");
+    if (forward)
+      cl.workerArgs.push_back(arg);
+
+    // Options without value
+    if (!strcmp(arg, "--async-io"))
+    {
+      cl.asyncIO = true;
+      continue;
+    }
+    if (!strcmp(arg, "--morton"))
+    {
+      g_mortonOrder = true;
+      continue;
+    }
+    if (!strcmp(arg, "--arc-length"))
+    {
+      g_arcLengthKeys = true;
+      continue;
+    }
+    if (!strcmp(arg, "--bounds"))
+    {
+      g_bounds = true;
+      continue;
+    }
+    if (!strcmp(arg, "--cache"))
+    {
+      cl.useCache = true;
+      continue;
+    }
+    if (!strcmp(arg, "--animation"))
+    {
+      cl.animation = true;
+      continue;
+    }
+    if (!strcmp(arg, "--batch"))
+    {
+      cl.batch = true;
+      continue;
+    }
+
+    if (i + 1 >= argc)
+      return false;
+    const char* val = argv[++i];
+    if (forward)
+      cl.workerArgs.push_back(val);
+
+    if (!strcmp(arg, "--precision"))
+    {
+      if (!strcmp(val, "shortest"))
+      {
+        g_floatFormat.mode = FLOAT_SHORTEST;
+        g_meshFormat.mode  = FLOAT_SHORTEST;
+      }
+      else
+      {
+        int digits;
+        if (!ParseNumber(val, digits) || digits < 0 || digits > 17)
+          return false;
+        g_floatFormat = NumberFormat(FLOAT_FIXED, digits);
+        g_meshFormat  = NumberFormat(FLOAT_FIXED, digits);
+      }
+    }
+    else if (!strcmp(arg, "--quantize"))
+    {
+      double step;
+      if (!ParseNumber(val, step) || step <= 0.0)
+        return false;
+      g_floatFormat = NumberFormat(FLOAT_QUANTIZED, 0, step);
+      g_meshFormat  = NumberFormat(FLOAT_QUANTIZED, 0, step);
+    }
+    else if (!strcmp(arg, "--weld"))
+    {
+      double eps;
+      if (!ParseNumber(val, eps) || eps < 0.0)
+        return false;
+      g_weldEpsilon = eps;
+    }
+    else if (!strcmp(arg, "--proxy-ratio"))
+    {
+      double ratio = atof(val);
+      if (ratio <= 0.0 || ratio > 1.0)
+        return false;
+      g_proxyRatio = ratio;
+    }
+    else if (!strcmp(arg, "--proxy-error"))
+    {
+      double err = atof(val);
+      if (err <= 0.0)
+        return false;
+      g_proxyError = err;
+      if (g_proxyRatio == 1.0)
+        g_proxyRatio = 0.0;
+    }
+    else if (!strcmp(arg, "--spline-tolerance"))
+    {
+      double tol = atof(val);
+      if (tol < 0.0)
+        return false;
+      g_splineTolerance = tol;
+    }
+    else if (!strcmp(arg, "--sweep-tolerance"))
+    {
+      double tol = atof(val);
+      if (tol < 0.0)
+        return false;
+      g_sweepTolerance = tol;
+    }
+    else if (!strcmp(arg, "--threads"))
+    {
+      int n = atoi(val);
+      if (n <= 0)
+        return false;
+      g_threads = n;
+      cl.threadsSet = true;
+    }
+    else if (!strcmp(arg, "--log-level"))
+    {
+      if (!ParseLogLevel(val, g_logLevel))
+        return false;
+      cl.logLevelSet = true;
+    }
+    else if (!strcmp(arg, "--buffer-size"))
+    {
+      int mb = atoi(val);
+      if (mb <= 0 || mb > 1024)
+        return false;
+      cl.bufferSize = (size_t)mb << 20;
+    }
+    else if (!strcmp(arg, "--jobs"))
+    {
+      int n = atoi(val);
+      if (n <= 0)
+        return false;
+#ifndef POV_BATCH_WORKERS
+      if (n > 1)
+      {
+        LogError("\n # --jobs: no worker processes on this platform\n");
+        return false;
+      }
+#endif
+      cl.jobs = n;
+    }
+    else if (!strcmp(arg, "--batch-status"))
+    {
+      // Internal: started as batch worker by RunBatch()
+      cl.batchStatus = val;
+    }
+    else if (!strcmp(arg, "--out-dir"))
+    {
+      cl.outDir = val;
+    }
+    else if (!strcmp(arg, "--watch"))
+    {
+      cl.watchDir = val;
+    }
+    else if (!strcmp(arg, "--debounce"))
+    {
+      int ms = atoi(val);
+      if (ms < 0)
+        return false;
+      cl.debounceMs = ms;
+    }
+    else if (!strcmp(arg, "--generate"))
+    {
+      if (!ParseGeneratorSpec(val, cl.scene))
+        return false;
+      cl.generate = true;
+    }
+    else
+    {
+      LogError("\n # Unknown option: %s\n", arg);
+      return false;
+    }
+  }
+
+  if (cl.generate)
+  {
+    cl.fnSave = cl.inputs.size() == 1 ? cl.inputs[0] : nullptr;
+    return cl.fnSave && !cl.batch && !cl.watchDir;
+  }
+  if (cl.watchDir)
+    return !cl.batch && cl.inputs.empty();
+  if (cl.batch)
+    return !cl.inputs.empty();
+
+  if (cl.inputs.size() != 2)
+    return false;
+  cl.fnLoad = cl.inputs[0];
+  cl.fnSave = cl.inputs[1];
+  return true;
+}
+
+//
+// Hash of the options that change the written SDL, cached SDL written
+// with other options is not used
+//
+static UInt64 OptionsHash()
+{
+  UInt64 h = 0;
+  for (const NumberFormat* f : { &g_floatFormat, &g_meshFormat })
+  {
+    h = HashBytes(&f->mode, sizeof(f->mode), h);
+    h = HashBytes(&f->precision, sizeof(f->precision), h);
+    h = HashBytes(&f->quantum, sizeof(f->quantum), h);
+  }
+  h = HashBytes(&g_weldEpsilon, sizeof(g_weldEpsilon), h);
+  h = HashBytes(&g_proxyRatio, sizeof(g_proxyRatio), h);
+  h = HashBytes(&g_proxyError, sizeof(g_proxyError), h);
+  h = HashBytes(&g_sweepTolerance, sizeof(g_sweepTolerance), h);
+  h = HashBytes(&g_splineTolerance, sizeof(g_splineTolerance), h);
+  h = HashBytes(&g_arcLengthKeys, sizeof(g_arcLengthKeys), h);
+  h = HashBytes(&g_bounds, sizeof(g_bounds), h);
+  return HashBytes(&g_mortonOrder, sizeof(g_mortonOrder), h);
+}
+
+//
+// Convert one file, returns false if it failed
+//
+static bool ExportFile(const char* fnLoad, const char* fnSave, const CommandLine& cl, const char* header, unsigned long long& bytes)
+{
+  OutputSink output(cl.bufferSize);
+  ExportContext context;
+  context.output = &output;
+  context.animation = cl.animation;
+  if (cl.animation)
+  {
+    filesystem::path anim(fnSave);
+    context.animFile = anim.replace_filename(anim.stem().string() + "_anim.inc").string();
+  }
+  g_export = &context;
+  sink = &output;
+  if (!output.Open(fnSave, cl.asyncIO))
+  {
+    LogError("\n # Can't open output file: %s\n", fnSave);
+    sink = nullptr;
+    g_export = nullptr;
+    return false;
+  }
+
+  ExportCache cache;
+  string cacheFile = string(fnSave) + ".cache";
+  if (cl.useCache)
+  {
+    if (!cache.Load(cacheFile.c_str(), OptionsHash()))
+      LogInfo(" # No usable export cache, writing all objects\n");
+    context.cache = &cache;
+  }
+
+  LogInfo(" # Writing data ...");
+  WriteString(header);
+
+  Bool res = LoadSaveC4DScene(fnLoad, nullptr);
+
+  bool written = output.Close();
+  if (!written)
+    LogError("\n # Error writing output file: %s\n", fnSave);
+
+  // Only a complete export is a valid cache for the next one
+  if (cl.useCache && res && written && !cache.Save(cacheFile.c_str()))
+    LogWarn(" # Can't write export cache: %s\n", cacheFile.c_str());
+
+  bytes = output.BytesWritten();
+  LogInfo(" # Done: %llu bytes, %llu flushes\n", output.BytesWritten(), output.FlushCount());
+  if (cl.useCache)
+    LogInfo(" # Cache hits: %zu of %zu objects (%.1f%%)\n", cache.Hits(), cache.Lookups(),
+            cache.Lookups() ? 100.0 * cache.Hits() / cache.Lookups() : 0.0);
+  if (context.trianglesSaved > 0)
+    LogInfo(" # Mesh triangles saved: %lld\n", context.trianglesSaved.load());
+  if (context.meshInstances > 0)
+    LogInfo(" # Mesh instances: %d (%d unique meshes)\n", (int)context.meshInstances, (int)context.meshCount);
+  sink = nullptr;
+  g_export = nullptr;
+  return res && written;
+}
+
+//
+// Batch mode: convert all inputs on worker processes, then print a
+// status and timing table. Returns false if any file failed.
+//
+static bool ExportBatch(CommandLine& cl, const char* header)
+{
+  BatchJobList list(cl.outDir);
+  for (const char* arg : cl.inputs)
+    if (!list.Add(arg))
+      return false;
+
+  auto convert = [&](const BatchJob& job, unsigned long long& bytes)
+  {
+    return ExportFile(job.input.c_str(), job.output.c_str(), cl, header, bytes);
+  };
+
+  // Worker process: the status file is the result
+  if (cl.batchStatus)
+  {
+    FILE* status = fopen(cl.batchStatus, "w");
+    if (!status)
+      return false;
+    if (!cl.logLevelSet)
+      g_logLevel = LOG_WARN;
+    vector<BatchResult> results = RunBatch(list.jobs, 1, convert, {}, status);
+    fclose(status);
+    return all_of(results.begin(), results.end(), [](const BatchResult& r) { return r.state == JOB_OK; });
+  }
+
+  if (cl.outDir)
+  {
+    error_code ec;
+    filesystem::create_directories(cl.outDir, ec);
+  }
+
+  // Share the cores between the workers, workers only report problems
+  unsigned workers = (unsigned)min((size_t)cl.jobs, list.jobs.size());
+  if (!cl.threadsSet)
+    g_threads = max(1u, g_threads / max(1u, workers));
+  LogInfo(" # Batch: %zu files, %u workers\n", list.jobs.size(), workers);
+
+  vector<string> workerArgs(cl.workerArgs.begin(), cl.workerArgs.end());
+  workerArgs.insert(workerArgs.begin(), "--batch");
+  if (!cl.threadsSet)
+  {
+    workerArgs.push_back("--threads");
+    workerArgs.push_back(to_string(g_threads));
+  }
+
+  LogLevel level = g_logLevel;
+  if (!cl.logLevelSet)
+    g_logLevel = LOG_WARN;
+
+  auto start = chrono::steady_clock::now();
+  vector<BatchResult> results = RunBatch(list.jobs, workers, convert, workerArgs);
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  g_logLevel = level;
+
+  static const char* states[] = { "pending", "running", "ok", "FAILED", "CRASHED" };
+  size_t ok = 0;
+  LogInfo("\n   %-8s %10s %14s  %s\n", "status", "seconds", "bytes", "file");
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const BatchResult& r = results[i];
+    LogInfo("   %-8s %10.3f %14llu  %s -> %s\n", states[r.state], r.seconds, r.bytes,
+            list.jobs[i].input.c_str(), list.jobs[i].output.c_str());
+    ok += r.state == JOB_OK;
+  }
+  LogInfo("\n # Batch done: %zu ok, %zu failed, %.1f s\n", ok, results.size() - ok, seconds);
+  return ok == results.size();
+}
+
+//
+// Watch mode: stay resident and export .c4d files of a directory when
+// they were saved. Outputs older than their scene are exported first,
+// and after the watcher lost events.
+//
+static bool WatchDirectory(CommandLine& cl, const char* header)
+{
+  DirWatcher watcher;
+  if (!watcher.Open(cl.watchDir, "*.c4d", cl.debounceMs))
+  {
+    LogError("\n # Can't watch directory: %s\n", cl.watchDir);
+    return false;
+  }
+  if (cl.outDir)
+  {
+    error_code ec;
+    filesystem::create_directories(cl.outDir, ec);
+  }
+
+  LogLevel level = g_logLevel;
+  auto exportFiles = [&](const vector<string>& files, bool staleOnly)
+  {
+    BatchJobList list(cl.outDir);
+    for (const string& f : files)
+      list.AddFile(f);
+
+    for (const BatchJob& job : list.jobs)
+    {
+      error_code ec;
+      if (staleOnly && filesystem::exists(job.output, ec) &&
+          filesystem::last_write_time(job.output, ec) >= filesystem::last_write_time(job.input, ec))
+        continue;
+
+      // Exports only report problems, the watcher reports the result
+      if (!cl.logLevelSet)
+        g_logLevel = LOG_WARN;
+      auto start = chrono::steady_clock::now();
+      unsigned long long bytes = 0;
+      bool ok = ExportFile(job.input.c_str(), job.output.c_str(), cl, header, bytes);
+      double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      g_logLevel = level;
+
+      if (ok)
+        LogInfo(" # %s -> %s: %llu bytes, %.3f s\n", job.input.c_str(), job.output.c_str(), bytes, seconds);
+      else
+        LogError(" # %s -> %s: FAILED\n", job.input.c_str(), job.output.c_str());
+    }
+  };
+
+  exportFiles(watcher.Files(), true);
+  LogInfo(" # Watching %s for saved .c4d files, Ctrl+C to stop\n", cl.watchDir);
+  for (;;)
+  {
+    bool rescan = false;
+    vector<string> files = watcher.Wait(rescan);
+    exportFiles(files, rescan);
+  }
+}
+
 int main(int argc, Char* argv[])
 {
   version = GetLibraryVersion().GetCStringCopy();
@@ -4767,32 +7301,82 @@ int main(int argc, Char* argv[])
 \n// Supported primitives: camera, sphere, cube, cone, cylinder, spline\
 \n//                       mesh2, prism, sphere sweep, lathe\
 \n//---------------------------------------------------------------\n\n", version);
-  printf(header);
 
-  if (argc < 3)
-  {
-    printf("\n\nUsage: export2pov <infile.c4d> <ouitfile.inc>\n");
+  CommandLine cl;
+  if (!ParseArgs(argc, argv, cl))
+  {
+    printf("\n\nUsage: export2pov [options] <infile.c4d> <ouitfile.inc>\n\
+       export2pov --batch [options] <infile.c4d | pattern | @manifest> ...\n\
+       export2pov --watch <dir> [options]\n\
+       export2pov --generate <spec> <outfile.c4d>\n\
+\nOptions:\n\
+  --precision <digits|shortest>  Decimals of written floats (default: 6, mesh data 10)\n\
+                                 'shortest' writes the shortest round-trip text\n\
+  --quantize <step>              Snap written floats to multiples of <step>\n\
+  --weld <epsilon>               Merge mesh points closer than <epsilon> (0: exact duplicates)\n\
+  --proxy-ratio <ratio>          Add decimated proxy meshes with <ratio> of the triangles,\n\
+                                 selected by '#declare C2P_Proxy = on;'\n\
+  --proxy-error <distance>       Limit proxy decimation error to <distance>\n\
+  --morton                       Sort mesh points and triangles along a Morton curve\n\
+  --spline-tolerance <distance>  Resample curves without POV counterpart into polylines\n\
+                                 and simplify linear splines within <distance>\n\
+                                 (default: 0, off)\n\
+  --arc-length                   Key spline arrays by normalized arc length, write length\n\
+                                 tables len_<name> and lookup macro C2P_ArcPoint()\n\
+  --sweep-tolerance <distance>   Insert points into linear sweep paths until the radius\n\
+                                 profile is within <distance> (default: 0, off)\n\
+  --bounds                       Write bounded_by boxes of sweeps, prisms, lathes and\n\
+                                 unions from exact object bounds\n\
+  --threads <n>                  Threads emitting objects and formatting large meshes\n\
+                                 (default: all cores)\n\
+  --buffer-size <MB>             Output buffer size (default: 4)\n\
+  --async-io                     Write output buffers from a background thread\n\
+  --cache                        Reuse SDL of unchanged objects from the previous export,\n\
+                                 kept in <outfile>.cache\n\
+  --animation                    Export the document frame range: animated objects read\n\
+                                 per-frame values from <outfile>_anim.inc by frame_number\n\
+  --log-level <level>            error, warn, info or trace (default: info)\n\
+\nBatch options:\n\
+  --batch                        Convert many files: .c4d files, patterns like scenes/*.c4d\n\
+                                 and @manifests with lines '<infile.c4d> [<outfile.inc>]'\n\
+  --jobs <n>                     Worker processes (default: 1)\n\
+  --out-dir <dir>                Folder of outputs not named by a manifest\n\
+                                 (default: next to the input)\n\
+\nWatch options:\n\
+  --watch <dir>                  Stay resident, export .c4d files of <dir> when saved\n\
+                                 (outputs like --batch, --out-dir applies)\n\
+  --debounce <ms>                Quiet time after the last write of a file (default: 500)\n\
+\nBenchmark scenes:\n\
+  --generate <spec>              Write a synthetic scene, <spec> is key=value,... of\n\
+                                 meshes, polys (quads per mesh, default 100), depth\n\
+                                 (nested Null/Boole levels), splines (sweeps), points\n\
+                                 (per sweep path, default 64), lights, materials (default 8)\n");
     DeleteMem(version);
     exit(1);
   }
 
-  const char* fnLoad = argv[1];
-  const char* fnSave = argv[2];
-  
-  file = fopen(fnSave, "w");
-  printf(" # Writing data ...");
-  fprintf(file, header);
-
-  Bool res = LoadSaveC4DScene(fnLoad, nullptr);
-
-  // Write objects instances 
-  for (auto item : objects)
-    fprintf(file, "object{ %s %s %s}\n\n", item[0].c_str(), item[1].c_str(), item[2].c_str());
+  // Forked batch workers must not inherit the log writer thread
+  if (!cl.batch)
+    LogStart();
+  if (!cl.batchStatus)
+    LogInfo("%s", header);
 
-  printf(" # Done\n");
-  fclose(file);
+  bool ok;
+  if (cl.generate)
+    ok = GenerateScene(cl.fnSave, cl.scene);
+  else if (cl.watchDir)
+    ok = WatchDirectory(cl, header);
+  else if (cl.batch)
+    ok = ExportBatch(cl, header);
+  else
+  {
+    unsigned long long bytes = 0;
+    ok = ExportFile(cl.fnLoad, cl.fnSave, cl, header, bytes);
+  }
+  LogStop();
 
   DeleteMem(version);
+  return ok ? 0 : 1;
 }
 
 //////////////////////////////////////////////////
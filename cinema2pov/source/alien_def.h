@@ -8,6 +8,7 @@
 #define ALIEN_DEF_H__
 
 #include "c4d.h"
+#include "pov_scene.h"
 
 //////////////////////////////////////////////////////////////////////////
 namespace cineware
@@ -75,14 +76,15 @@ public:
 };
 
 // self-defined null object data with own functions and members
-class AlienNullObjectData : public NodeData
+class AlienNullObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienNullObjectData, NodeData)
 
-	bool exported = false;
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined foreground object data with own functions and members
@@ -145,7 +147,7 @@ public:
 };
 
 // self-defined polygon object data with own functions and members
-class AlienPolygonObjectData : public PolygonObjectData
+class AlienPolygonObjectData : public PolygonObjectData, public SceneEmitter
 {
 	INSTANCEOF(AlienPolygonObjectData, PolygonObjectData)
 
@@ -153,50 +155,58 @@ public:
 	Int32 layid;
 	Int32 matid;
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
+	virtual void Skip(SceneNode* node);
 };
 
 // self-defined camera object data with own functions and members
-class AlienCameraObjectData : public CameraObjectData
+class AlienCameraObjectData : public CameraObjectData, public SceneEmitter
 {
 	INSTANCEOF(AlienCameraObjectData, CameraObjectData)
-		bool exported = false;
 public:
 	float horizontalFieldOfView;
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual int Animate(SceneNode* node, double* values);
 };
 
 // self-defined primitive object data with own functions and members
-class AlienPrimitiveObjectData : public NodeData
+class AlienPrimitiveObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienPrimitiveObjectData, NodeData)
 
 	Int32 type_id;
 	Int32 matid;
-	bool exported = false;
 public:
 	AlienPrimitiveObjectData(Int32 id) : type_id(id) {}
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
+	virtual int Animate(SceneNode* node, double* values);
 };
 
 // self-defined spline object with own functions and members
-class AlienSplineObject : public SplineObject
+class AlienSplineObject : public SplineObject, public SceneEmitter
 {
 	INSTANCEOF(AlienSplineObject, SplineObject)
-		bool exported = false;
 public:
 	virtual Bool Execute();
-	void SetExported() { exported = true; }
+	virtual void Emit(SceneNode* node);
 };
 
 // self-defined light object data with own functions and members
-class AlienLightObjectData : public LightObjectData
+class AlienLightObjectData : public LightObjectData, public SceneEmitter
 {
 	INSTANCEOF(AlienLightObjectData, LightObjectData)
 
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual int Animate(SceneNode* node, double* values);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined LOD object data with own functions and members
@@ -239,47 +249,51 @@ public:
 };
 
 // self-defined boolean object data with own functions and members
-class AlienBoolObjectData : public NodeData
+class AlienBoolObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienBoolObjectData, NodeData)
 
-	bool exported = false;
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined instance object data with own functions and members
-class AlienExtrudeObjectData : public NodeData
+class AlienExtrudeObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienExtrudeObjectData, NodeData)
 
-	bool exported = false;
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined instance object data with own functions and members
-class AlienSweepObjectData : public NodeData
+class AlienSweepObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienSweepObjectData, NodeData)
 
-		bool exported = false;
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined instance object data with own functions and members
-class AlienLatheObjectData : public NodeData
+class AlienLatheObjectData : public NodeData, public SceneEmitter
 {
 	INSTANCEOF(AlienLatheObjectData, NodeData)
 
-		bool exported = false;
 public:
 
 	virtual Bool Execute();
+	virtual void Emit(SceneNode* node);
+	virtual bool Bound(const SceneNode* node, Bounds& bounds);
 };
 
 // self-defined deformer object data with own functions and members
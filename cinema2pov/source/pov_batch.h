@@ -0,0 +1,498 @@
+//------------------------------------------------------------------------
+// Batch conversion
+//
+// Inputs are .c4d files, glob patterns with '*' and '?' in the file name
+// ("scenes/c4d/*.c4d") and @manifest files. A manifest lists one job per
+// line: "<infile.c4d> [<outfile.inc>]", paths relative to the manifest,
+// quoted if they contain spaces, '#' starts a comment. Outputs default to
+// the input name with .inc extension, next to it or in the output folder.
+//
+// The SDK and the exporter keep per-document state in globals, so jobs
+// don't run on threads. On POSIX systems worker processes are forked
+// once and take jobs from a shared counter, each converting many files
+// without a new process and SDK start; a crashed worker only fails its
+// current job and is replaced.
+//
+// On Windows the exe is started again per worker with the batch options,
+// a manifest of its share of the jobs and a status file. The worker
+// writes a line when a job starts and when it ends; the status files are
+// merged into the results, a crashed worker is replaced by one for the
+// jobs it didn't start. Other platforms have no workers.
+//------------------------------------------------------------------------
+#ifndef POV_BATCH_H__
+#define POV_BATCH_H__
+
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+#include "pov_log.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#define POV_BATCH_FORK
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#elif defined(_WIN32)
+#define POV_BATCH_SPAWN
+#include <mutex>
+#include <thread>
+#include <process.h>
+#include <condition_variable>
+#endif
+
+#if defined(POV_BATCH_FORK) || defined(POV_BATCH_SPAWN)
+#define POV_BATCH_WORKERS
+#endif
+
+struct BatchJob
+{
+  std::string input;
+  std::string output;
+};
+
+enum BatchState
+{
+  JOB_PENDING,
+  JOB_RUNNING,
+  JOB_OK,
+  JOB_FAILED,
+  JOB_CRASHED,   // worker process died during the job
+};
+
+struct BatchResult
+{
+  BatchState state = JOB_PENDING;
+  double seconds = 0.0;
+  unsigned long long bytes = 0;
+};
+
+//
+// '*' and '?' wildcard match, case insensitive on Windows
+//
+inline bool WildcardMatch(const char* pattern, const char* name)
+{
+  const char* star = nullptr;
+  const char* resume = nullptr;
+  while (*name)
+  {
+#ifdef _WIN32
+    bool same = tolower((unsigned char)*pattern) == tolower((unsigned char)*name);
+#else
+    bool same = *pattern == *name;
+#endif
+    if (*pattern == '?' || (*pattern && *pattern != '*' && same))
+    {
+      pattern++;
+      name++;
+    }
+    else if (*pattern == '*')
+    {
+      star = pattern++;
+      resume = name;
+    }
+    else if (star)
+    {
+      pattern = star + 1;
+      name = ++resume;
+    }
+    else
+      return false;
+  }
+  while (*pattern == '*')
+    pattern++;
+  return !*pattern;
+}
+
+class BatchJobList
+{
+public:
+  std::vector<BatchJob> jobs;
+
+  explicit BatchJobList(const char* outDir) : outDir(outDir ? outDir : "") {}
+
+  //
+  // Add jobs of a command line argument: file, pattern or @manifest.
+  // Returns false if nothing could be added.
+  //
+  bool Add(const char* arg)
+  {
+    if (arg[0] == '@')
+      return AddManifest(arg + 1);
+    if (strpbrk(arg, "*?"))
+      return AddPattern(arg);
+    AddFile(arg);
+    return true;
+  }
+
+  // Add job of one file, named output or default name
+  void AddFile(const std::string& input, const std::string& output = "")
+  {
+    if (!known.insert(input).second)
+      return;
+
+    std::filesystem::path out(output);
+    if (output.empty())
+    {
+      out = std::filesystem::path(input).replace_extension(".inc");
+      if (!outDir.empty())
+        out = std::filesystem::path(outDir) / out.filename();
+    }
+    jobs.push_back({ input, out.string() });
+  }
+
+private:
+  bool AddPattern(const char* arg)
+  {
+    std::filesystem::path path(arg);
+    std::filesystem::path dir = path.parent_path();
+    std::string pattern = path.filename().string();
+
+    std::error_code ec;
+    std::vector<std::string> found;
+    for (std::filesystem::directory_iterator it(dir.empty() ? "." : dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+      std::string name = it->path().filename().string();
+      if (it->is_regular_file(ec) && WildcardMatch(pattern.c_str(), name.c_str()))
+        found.push_back((dir / name).string());
+    }
+
+    if (found.empty())
+    {
+      LogError("\n # No files match: %s\n", arg);
+      return false;
+    }
+    std::sort(found.begin(), found.end());
+    for (const std::string& f : found)
+      AddFile(f);
+    return true;
+  }
+
+  bool AddManifest(const char* fn)
+  {
+    std::ifstream in(fn);
+    if (!in)
+    {
+      LogError("\n # Can't open manifest: %s\n", fn);
+      return false;
+    }
+
+    std::filesystem::path base = std::filesystem::path(fn).parent_path();
+    std::string line;
+    for (int n = 1; std::getline(in, line); n++)
+    {
+      std::vector<std::string> fields;
+      if (!SplitLine(line, fields) || fields.size() > 2)
+      {
+        LogError("\n # %s:%d: expected <infile.c4d> [<outfile.inc>]\n", fn, n);
+        return false;
+      }
+      if (fields.empty())
+        continue;
+
+      std::string input = (base / fields[0]).string();
+      std::string output = fields.size() > 1 ? (base / fields[1]).string() : "";
+      AddFile(input, output);
+    }
+    return true;
+  }
+
+  // Whitespace separated fields, "quoted" with spaces, '#' comment
+  static bool SplitLine(const std::string& line, std::vector<std::string>& fields)
+  {
+    size_t i = 0;
+    while (i < line.size())
+    {
+      if (isspace((unsigned char)line[i]))
+      {
+        i++;
+        continue;
+      }
+      if (line[i] == '#')
+        break;
+
+      if (line[i] == '"')
+      {
+        size_t end = line.find('"', i + 1);
+        if (end == std::string::npos)
+          return false;
+        fields.push_back(line.substr(i + 1, end - i - 1));
+        i = end + 1;
+      }
+      else
+      {
+        size_t end = i;
+        while (end < line.size() && !isspace((unsigned char)line[end]))
+          end++;
+        fields.push_back(line.substr(i, end - i));
+        i = end;
+      }
+    }
+    return true;
+  }
+
+  std::string outDir;
+  std::unordered_set<std::string> known;
+};
+
+//
+// Status file of a worker process: "<job> <state> <seconds> <bytes>" per
+// started and per finished job, the last line of a job counts
+//
+inline void WriteBatchStatus(FILE* f, size_t i, const BatchResult& r)
+{
+  fprintf(f, "%zu %d %.6f %llu\n", i, (int)r.state, r.seconds, r.bytes);
+  fflush(f);
+}
+
+// Merge status file 'fn' of the jobs 'slice' into 'results'
+inline void ReadBatchStatus(const std::string& fn, const std::vector<size_t>& slice, std::vector<BatchResult>& results)
+{
+  FILE* f = fopen(fn.c_str(), "r");
+  if (!f)
+    return;
+  size_t i;
+  int state;
+  BatchResult r;
+  while (fscanf(f, "%zu %d %lf %llu", &i, &state, &r.seconds, &r.bytes) == 4)
+    if (i < slice.size() && state >= JOB_PENDING && state <= JOB_CRASHED)
+    {
+      r.state = (BatchState)state;
+      results[slice[i]] = r;
+    }
+  fclose(f);
+}
+
+#ifdef POV_BATCH_SPAWN
+//
+// Windows worker pool: each worker is this exe, started with 'args' and
+// "--batch-status <file> @<manifest>" for its share of the jobs. Returns
+// false if no worker could be started.
+//
+inline bool SpawnBatch(const std::vector<BatchJob>& jobs, unsigned workers, const std::vector<std::string>& args,
+                       std::vector<BatchResult>& results)
+{
+  char* exe = nullptr;
+  if (_get_pgmptr(&exe) != 0 || !exe || !*exe)
+    return false;
+
+  std::error_code ec;
+  std::filesystem::path dir = std::filesystem::temp_directory_path(ec) /
+                              ("cinema2pov_batch_" + std::to_string(_getpid()));
+  if (ec || !std::filesystem::create_directories(dir, ec))
+    return false;
+
+  struct Worker
+  {
+    std::vector<size_t> slice;  // job indices
+    std::string status;
+    std::thread waiter;
+  };
+  std::vector<Worker> started;  // by worker number
+  std::vector<size_t> exited;
+  std::mutex mutex;
+  std::condition_variable wake;
+  size_t running = 0;
+
+  // _spawnv() joins the arguments with spaces
+  auto quote = [](const std::string& s) { return "\"" + s + "\""; };
+
+  auto spawn = [&](std::vector<size_t> slice)
+  {
+    size_t id = started.size();
+    std::string base = (dir / ("worker" + std::to_string(id))).string();
+    std::string manifest = base + ".txt";
+    std::string status = base + ".status";
+    FILE* f = fopen(manifest.c_str(), "w");
+    if (!f)
+      return false;
+    for (size_t i : slice)
+      fprintf(f, "\"%s\" \"%s\"\n", std::filesystem::absolute(jobs[i].input, ec).string().c_str(),
+              std::filesystem::absolute(jobs[i].output, ec).string().c_str());
+    fclose(f);
+
+    std::vector<std::string> argv = { quote(exe) };
+    for (const std::string& a : args)
+      argv.push_back(quote(a));
+    argv.push_back("--batch-status");
+    argv.push_back(quote(status));
+    argv.push_back(quote("@" + manifest));
+    std::vector<const char*> ptrs;
+    for (const std::string& a : argv)
+      ptrs.push_back(a.c_str());
+    ptrs.push_back(nullptr);
+
+    fflush(stdout);
+    fflush(stderr);
+    intptr_t process = _spawnv(_P_NOWAIT, exe, ptrs.data());
+    if (process == -1)
+      return false;
+
+    started.push_back({ std::move(slice), status, std::thread() });
+    started.back().waiter = std::thread([&, id, process]()
+    {
+      int code = 0;
+      _cwait(&code, process, 0);
+      std::lock_guard<std::mutex> lock(mutex);
+      exited.push_back(id);
+      wake.notify_all();
+    });
+    running++;
+    return true;
+  };
+
+  // Every workers-th job, so each worker gets early and late files
+  workers = (unsigned)std::min<size_t>(workers, jobs.size());
+  for (unsigned w = 0; w < workers; w++)
+  {
+    std::vector<size_t> slice;
+    for (size_t i = w; i < jobs.size(); i += workers)
+      slice.push_back(i);
+    spawn(std::move(slice));
+  }
+  if (running == 0)
+  {
+    std::filesystem::remove_all(dir, ec);
+    return false;
+  }
+
+  while (running > 0)
+  {
+    size_t id;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return !exited.empty(); });
+      id = exited.back();
+      exited.pop_back();
+    }
+    running--;
+
+    // A job still running crashed the worker, the jobs after it get a
+    // new one. No new worker if this one didn't start any job.
+    const Worker& w = started[id];
+    ReadBatchStatus(w.status, w.slice, results);
+    std::vector<size_t> left;
+    for (size_t i : w.slice)
+    {
+      if (results[i].state == JOB_RUNNING)
+        results[i].state = JOB_CRASHED;
+      else if (results[i].state == JOB_PENDING)
+        left.push_back(i);
+    }
+    if (!left.empty() && left.size() < w.slice.size())
+      spawn(std::move(left));
+  }
+
+  for (Worker& w : started)
+    w.waiter.join();
+  std::filesystem::remove_all(dir, ec);
+  return true;
+}
+#endif
+
+//
+// Run convert(job, bytes) for all jobs on 'workers' processes, returns
+// one result per job. Windows workers are started with 'workerArgs'. A
+// worker process itself passes its 'status' file.
+//
+template <class F>
+inline std::vector<BatchResult> RunBatch(const std::vector<BatchJob>& jobs, unsigned workers, F convert,
+                                         const std::vector<std::string>& workerArgs, FILE* status = nullptr)
+{
+#ifndef POV_BATCH_SPAWN
+  (void)workerArgs;
+#endif
+  size_t count = jobs.size();
+  std::vector<BatchResult> results(count);
+  auto run = [&](size_t i, BatchResult& r)
+  {
+    auto start = std::chrono::steady_clock::now();
+    r.state = JOB_RUNNING;
+    if (status)
+      WriteBatchStatus(status, i, r);
+    bool ok = convert(jobs[i], r.bytes);
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.state = ok ? JOB_OK : JOB_FAILED;
+    if (status)
+      WriteBatchStatus(status, i, r);
+  };
+
+#ifdef POV_BATCH_FORK
+  if (workers > 1 && count > 1)
+  {
+    // Shared by the workers: job counter and results
+    size_t size = sizeof(std::atomic<size_t>) + count * sizeof(BatchResult);
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED)
+    {
+      std::atomic<size_t>* next = new (mem) std::atomic<size_t>(0);
+      BatchResult* shared = (BatchResult*)(next + 1);
+      for (size_t i = 0; i < count; i++)
+        new (shared + i) BatchResult();
+
+      auto spawn = [&]()
+      {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid != 0)
+          return pid > 0;
+
+        // Keep log lines of a crashing job
+        setvbuf(stdout, nullptr, _IOLBF, BUFSIZ);
+        for (size_t i; (i = (*next)++) < count;)
+          run(i, shared[i]);
+        fflush(stdout);
+        _exit(0);
+      };
+
+      unsigned running = 0;
+      for (unsigned w = 0; w < std::min((size_t)workers, count); w++)
+        running += spawn();
+
+      while (running > 0)
+      {
+        int status = 0;
+        if (wait(&status) < 0)
+          break;
+        running--;
+
+        // Replace a crashed worker while there is work left
+        bool crashed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        if (crashed && next->load() < count)
+          running += spawn();
+      }
+
+      for (size_t i = 0; i < count; i++)
+      {
+        results[i] = shared[i];
+        if (results[i].state == JOB_RUNNING)
+          results[i].state = JOB_CRASHED;
+      }
+      munmap(mem, size);
+      return results;
+    }
+    LogWarn("\n # Can't share memory with worker processes, converting one file at a time\n");
+  }
+#elif defined(POV_BATCH_SPAWN)
+  if (workers > 1 && count > 1)
+  {
+    if (SpawnBatch(jobs, workers, workerArgs, results))
+      return results;
+    LogWarn("\n # Can't start worker processes, converting one file at a time\n");
+  }
+#endif
+
+  for (size_t i = 0; i < count; i++)
+    run(i, results[i]);
+  return results;
+}
+
+#endif // POV_BATCH_H__
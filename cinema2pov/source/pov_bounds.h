@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------
+// Axis aligned bounding boxes for bounded_by
+//
+// POV-Ray bounds sphere_sweeps, prisms and lathes by their control
+// points, CSG by its children, and can't bound objects containing
+// infinite ones at all. The exporter computes exact object space boxes
+// of what it writes and passes them on through unions and booleans.
+//
+// Curves are bounded per segment in Bezier form: the range of a cubic
+// Bezier is found from the roots of its derivative, Catmull-Rom and
+// uniform B-spline segments are converted to Bezier first.
+//------------------------------------------------------------------------
+#ifndef POV_BOUNDS_H__
+#define POV_BOUNDS_H__
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+struct Bounds
+{
+  double lo[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL };
+  double hi[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+
+  bool Empty() const
+  {
+    return lo[0] > hi[0] || lo[1] > hi[1] || lo[2] > hi[2];
+  }
+
+  void Add(double x, double y, double z)
+  {
+    const double v[3] = { x, y, z };
+    for (int i = 0; i < 3; i++)
+    {
+      lo[i] = std::min(lo[i], v[i]);
+      hi[i] = std::max(hi[i], v[i]);
+    }
+  }
+
+  void Add(const Bounds& b)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      lo[i] = std::min(lo[i], b.lo[i]);
+      hi[i] = std::max(hi[i], b.hi[i]);
+    }
+  }
+
+  void Intersect(const Bounds& b)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      lo[i] = std::max(lo[i], b.lo[i]);
+      hi[i] = std::min(hi[i], b.hi[i]);
+    }
+  }
+
+  //
+  // Box of this box transformed by matrix 'm' (v1, v2, v3, off as
+  // written by WriteMatrix): per axis, the extremes of the sum of the
+  // row terms are the sums of their extremes
+  //
+  Bounds Transformed(const double* m) const
+  {
+    Bounds b;
+    if (Empty())
+      return b;
+    for (int j = 0; j < 3; j++)
+    {
+      b.lo[j] = b.hi[j] = m[9 + j];
+      for (int i = 0; i < 3; i++)
+      {
+        double e0 = m[i * 3 + j] * lo[i];
+        double e1 = m[i * 3 + j] * hi[i];
+        b.lo[j] += std::min(e0, e1);
+        b.hi[j] += std::max(e0, e1);
+      }
+    }
+    return b;
+  }
+};
+
+//
+// Extend [lo, hi] by the range of the cubic Bezier a, b, c, d on [0, 1]
+//
+inline void BezierRange(double a, double b, double c, double d, double& lo, double& hi)
+{
+  auto extend = [&](double t)
+  {
+    double s = 1.0 - t;
+    double v = s * s * s * a + 3.0 * s * s * t * b + 3.0 * s * t * t * c + t * t * t * d;
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  };
+  extend(0.0);
+  extend(1.0);
+
+  // Derivative / 3 = A t^2 + B t + C
+  double p = b - a, q = c - b, r = d - c;
+  double A = p - 2.0 * q + r, B = 2.0 * (q - p), C = p;
+  if (std::fabs(A) < 1e-12)
+  {
+    if (std::fabs(B) > 1e-12)
+    {
+      double t = -C / B;
+      if (t > 0.0 && t < 1.0)
+        extend(t);
+    }
+    return;
+  }
+  double disc = B * B - 4.0 * A * C;
+  if (disc < 0.0)
+    return;
+  double sq = std::sqrt(disc);
+  for (double t : { (-B - sq) / (2.0 * A), (-B + sq) / (2.0 * A) })
+    if (t > 0.0 && t < 1.0)
+      extend(t);
+}
+
+enum CurveBasis
+{
+  CURVE_LINEAR,       // polyline through the points
+  CURVE_CATMULL_ROM,  // POV-Ray cubic_spline: first and last point are controls
+  CURVE_BSPLINE,      // uniform cubic B-spline, b_spline of sphere_sweep
+  CURVE_BEZIER,       // groups of 4: point, control, control, point
+};
+
+//
+// Extend [lo, hi] by the range of one coordinate of a curve, 'v(i)' is the
+// coordinate of written control point i of 'n'
+//
+template <class F>
+inline void CurveRange(CurveBasis basis, size_t n, F v, double& lo, double& hi)
+{
+  switch (basis)
+  {
+    case CURVE_LINEAR:
+      for (size_t i = 0; i < n; i++)
+      {
+        lo = std::min(lo, (double)v(i));
+        hi = std::max(hi, (double)v(i));
+      }
+      break;
+
+    case CURVE_CATMULL_ROM:
+      for (size_t i = 1; i + 2 < n; i++)
+      {
+        double p0 = v(i - 1), p1 = v(i), p2 = v(i + 1), p3 = v(i + 2);
+        BezierRange(p1, p1 + (p2 - p0) / 6.0, p2 - (p3 - p1) / 6.0, p2, lo, hi);
+      }
+      break;
+
+    case CURVE_BSPLINE:
+      for (size_t i = 1; i + 2 < n; i++)
+      {
+        double p0 = v(i - 1), p1 = v(i), p2 = v(i + 1), p3 = v(i + 2);
+        BezierRange((p0 + 4.0 * p1 + p2) / 6.0, (2.0 * p1 + p2) / 3.0, (p1 + 2.0 * p2) / 3.0, (p1 + 4.0 * p2 + p3) / 6.0, lo, hi);
+      }
+      break;
+
+    case CURVE_BEZIER:
+      for (size_t i = 0; i + 3 < n; i += 4)
+        BezierRange(v(i), v(i + 1), v(i + 2), v(i + 3), lo, hi);
+      break;
+  }
+}
+
+#endif // POV_BOUNDS_H__
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------
+// Export cache - SDL of unchanged objects from the previous export
+//
+// A sidecar file next to the output maps the unique ID of each top level
+// object to the content hash of its subtree and the SDL written for it.
+// Subtrees with the same ID and hash are copied from the cache instead
+// of being emitted again. The file also records a hash of the export
+// options; a cache written with other options is ignored as a whole.
+//
+// File layout (native byte order):
+//   "C2PCACHE" version:u32 options:u64 count:u32
+//   count * { keyLen:u32 key hash:u64 sdlLen:u64 sdl }
+//------------------------------------------------------------------------
+#ifndef POV_CACHE_H__
+#define POV_CACHE_H__
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+class ExportCache
+{
+public:
+  static constexpr uint32_t VERSION = 1;  // bump when emitters change their output
+
+  //
+  // Read cache file. Returns false if it is missing, damaged or was
+  // written with other options - the cache is empty then.
+  //
+  bool Load(const char* fn, uint64_t optionsHash)
+  {
+    options = optionsHash;
+    entries.clear();
+
+    FILE* fh = fopen(fn, "rb");
+    if (!fh)
+      return false;
+
+    fseek(fh, 0, SEEK_END);
+    long size = ftell(fh);
+    fseek(fh, 0, SEEK_SET);
+
+    bool ok = size > 0 && ReadEntries(fh, (uint64_t)size);
+    fclose(fh);
+    if (!ok)
+      entries.clear();
+    return ok;
+  }
+
+  //
+  // Cached SDL of object 'key' with content 'hash', nullptr if unknown
+  // or changed
+  //
+  const std::string* Find(const std::string& key, uint64_t hash)
+  {
+    lookups++;
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.hash != hash)
+      return nullptr;
+    hits++;
+    return &it->second.sdl;
+  }
+
+  //
+  // Entries of the next cache file: Keep() carries an unchanged entry
+  // over, Put() stores newly emitted SDL
+  //
+  void Keep(const std::string& key)
+  {
+    auto it = entries.find(key);
+    if (it != entries.end())
+      next[key] = std::move(it->second);
+  }
+
+  void Put(const std::string& key, uint64_t hash, std::string&& sdl)
+  {
+    Entry& e = next[key];
+    e.hash = hash;
+    e.sdl = std::move(sdl);
+  }
+
+  //
+  // Write the entries of this export, dropping objects that are gone
+  //
+  bool Save(const char* fn)
+  {
+    FILE* fh = fopen(fn, "wb");
+    if (!fh)
+      return false;
+
+    uint32_t count = (uint32_t)next.size();
+    bool ok = fwrite("C2PCACHE", 1, 8, fh) == 8 &&
+              WriteValue(fh, VERSION) && WriteValue(fh, options) && WriteValue(fh, count);
+
+    for (auto it = next.begin(); ok && it != next.end(); ++it)
+    {
+      uint32_t keyLen = (uint32_t)it->first.size();
+      uint64_t sdlLen = it->second.sdl.size();
+      ok = WriteValue(fh, keyLen) && fwrite(it->first.data(), 1, keyLen, fh) == keyLen &&
+           WriteValue(fh, it->second.hash) &&
+           WriteValue(fh, sdlLen) && fwrite(it->second.sdl.data(), 1, sdlLen, fh) == sdlLen;
+    }
+
+    if (fclose(fh) != 0)
+      ok = false;
+    if (!ok)
+      remove(fn);
+    return ok;
+  }
+
+  size_t Lookups() const { return lookups; }
+  size_t Hits() const { return hits; }
+
+private:
+  struct Entry
+  {
+    uint64_t hash = 0;
+    std::string sdl;
+  };
+
+  template <class T>
+  static bool ReadValue(FILE* fh, T& v)
+  {
+    return fread(&v, sizeof(T), 1, fh) == 1;
+  }
+
+  template <class T>
+  static bool WriteValue(FILE* fh, const T& v)
+  {
+    return fwrite(&v, sizeof(T), 1, fh) == 1;
+  }
+
+  bool ReadEntries(FILE* fh, uint64_t size)
+  {
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t fileOptions = 0;
+    uint32_t count = 0;
+    if (fread(magic, 1, 8, fh) != 8 || memcmp(magic, "C2PCACHE", 8) ||
+        !ReadValue(fh, version) || version != VERSION ||
+        !ReadValue(fh, fileOptions) || fileOptions != options ||
+        !ReadValue(fh, count))
+      return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t keyLen = 0;
+      uint64_t sdlLen = 0;
+      std::string key;
+      Entry e;
+      // Lengths are checked against the file size before allocating
+      if (!ReadValue(fh, keyLen) || keyLen > size)
+        return false;
+      key.resize(keyLen);
+      if (fread(&key[0], 1, keyLen, fh) != keyLen ||
+          !ReadValue(fh, e.hash) || !ReadValue(fh, sdlLen) || sdlLen > size)
+        return false;
+      e.sdl.resize((size_t)sdlLen);
+      if (sdlLen && fread(&e.sdl[0], 1, (size_t)sdlLen, fh) != sdlLen)
+        return false;
+      entries[key] = std::move(e);
+    }
+    return true;
+  }
+
+  uint64_t options = 0;
+  std::unordered_map<std::string, Entry> entries;  // loaded
+  std::unordered_map<std::string, Entry> next;     // to be saved
+  size_t lookups = 0;
+  size_t hits = 0;
+};
+
+#endif // POV_CACHE_H__
@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------
+// Spline resampling for prism, lathe, sphere_sweep and spline output
+//
+// Curves POV-Ray can't represent are written as polylines. Segments are
+// subdivided adaptively: a piece is split while the curve deviates from
+// its chord by more than the chord tolerance, probed at its quarter
+// points, or the chords of its halves turn by more than the angle
+// tolerance. Straight stretches stay one segment, tight bends get many.
+//
+// Dense polylines are simplified by Douglas-Peucker: points closer than
+// the tolerance to the simplified line are dropped.
+//
+// Point type P needs x, y, z members (cineware::Vector).
+//------------------------------------------------------------------------
+#ifndef POV_CURVE_H__
+#define POV_CURVE_H__
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+struct CurvePoint
+{
+  double x, y, z;
+};
+
+template <class P>
+inline CurvePoint ToCurvePoint(const P& p)
+{
+  return { p.x, p.y, p.z };
+}
+
+inline CurvePoint CurveLerp(const CurvePoint& a, const CurvePoint& b, double u)
+{
+  return { a.x + (b.x - a.x) * u, a.y + (b.y - a.y) * u, a.z + (b.z - a.z) * u };
+}
+
+inline double CurveDistance(const CurvePoint& a, const CurvePoint& b)
+{
+  double dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Distance of p from segment a-b
+inline double SegmentDistance(const CurvePoint& p, const CurvePoint& a, const CurvePoint& b)
+{
+  double dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+  double len = dx * dx + dy * dy + dz * dz;
+  double u = len > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy + (p.z - a.z) * dz) / len : 0.0;
+  u = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+  return CurveDistance(p, CurveLerp(a, b, u));
+}
+
+// Angle in radians between directions a->b and b->c, 0 for degenerate ones
+inline double TurnAngle(const CurvePoint& a, const CurvePoint& b, const CurvePoint& c)
+{
+  double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+  double vx = c.x - b.x, vy = c.y - b.y, vz = c.z - b.z;
+  double lu = std::sqrt(ux * ux + uy * uy + uz * uz);
+  double lv = std::sqrt(vx * vx + vy * vy + vz * vz);
+  if (lu <= 0.0 || lv <= 0.0)
+    return 0.0;
+  double c0 = (ux * vx + uy * vy + uz * vz) / (lu * lv);
+  return std::acos(c0 > 1.0 ? 1.0 : (c0 < -1.0 ? -1.0 : c0));
+}
+
+//
+// Cumulative arc length of polyline 'p': len[i] is the length up to point i.
+// A 'closed' polyline gets len[count], the length back to point 0.
+//
+template <class P>
+inline void ArcLengthTable(const P* p, size_t count, std::vector<double>& len, bool closed = false)
+{
+  len.resize(closed && count > 0 ? count + 1 : count);
+  double sum = 0.0;
+  for (size_t i = 0; i < len.size(); i++)
+  {
+    if (i > 0)
+      sum += CurveDistance(ToCurvePoint(p[i - 1]), ToCurvePoint(p[i % count]));
+    len[i] = sum;
+  }
+}
+
+//
+// Polyline of curve 'eval(segment, u)', u in [0, 1], for 'segments'
+// segments. The end point of the last segment is added if 'end' is set.
+//
+template <class F>
+inline void ResampleCurve(F eval, size_t segments, double chordTolerance, double angleTolerance, bool end, std::vector<CurvePoint>& out)
+{
+  const int MAX_DEPTH = 10;  // at most 1024 pieces per segment
+
+  struct Piece
+  {
+    double u0, u1;
+    CurvePoint a, b;
+    int depth;
+  };
+
+  std::vector<Piece> stack;
+  for (size_t s = 0; s < segments; s++)
+  {
+    // Depth first, second half pushed first: pieces come out in order
+    stack.push_back({ 0.0, 1.0, eval(s, 0.0), eval(s, 1.0), 0 });
+    while (!stack.empty())
+    {
+      Piece pc = stack.back();
+      stack.pop_back();
+
+      // Quarter points catch S-bends whose middle lies on the chord
+      double um = 0.5 * (pc.u0 + pc.u1);
+      CurvePoint m = eval(s, um);
+      bool split = false;
+      if (pc.depth < MAX_DEPTH)
+      {
+        double error = SegmentDistance(m, pc.a, pc.b);
+        for (double f : { 0.25, 0.75 })
+          error = std::max(error, SegmentDistance(eval(s, pc.u0 + f * (pc.u1 - pc.u0)), pc.a, pc.b));
+        split = error > chordTolerance || TurnAngle(pc.a, m, pc.b) > angleTolerance;
+      }
+      if (split)
+      {
+        stack.push_back({ um, pc.u1, m, pc.b, pc.depth + 1 });
+        stack.push_back({ pc.u0, um, pc.a, m, pc.depth + 1 });
+      }
+      else
+        out.push_back(pc.a);
+    }
+  }
+  if (end && segments > 0)
+    out.push_back(eval(segments - 1, 1.0));
+}
+
+//
+// Douglas-Peucker simplification of polyline 'p', returns the indices of
+// the kept points in order. First and last point are always kept. A
+// 'closed' polyline is a ring: it is split at two far apart points, the
+// one farthest from point 0 and the one farthest from that, and both
+// arcs between them are simplified.
+//
+template <class P>
+inline void SimplifyPolyline(const P* p, size_t count, double tolerance, std::vector<size_t>& keep, bool closed = false)
+{
+  keep.clear();
+  if (count < 3)
+  {
+    for (size_t i = 0; i < count; i++)
+      keep.push_back(i);
+    return;
+  }
+
+  std::vector<bool> kept(count, false);
+  std::vector<std::pair<size_t, size_t>> stack;
+  if (closed)
+  {
+    auto farthest = [&](size_t from)
+    {
+      CurvePoint a = ToCurvePoint(p[from]);
+      size_t far = from;
+      double dist = -1.0;
+      for (size_t i = 0; i < count; i++)
+      {
+        double d = CurveDistance(a, ToCurvePoint(p[i]));
+        if (d > dist)
+        {
+          dist = d;
+          far = i;
+        }
+      }
+      return far;
+    };
+    size_t f = farthest(0);
+    size_t g = farthest(f);
+    if (f == g)
+      g = (f + 1) % count;
+    if (f > g)
+      std::swap(f, g);
+    kept[f] = kept[g] = true;
+    stack = { { f, g }, { g, f + count } };  // indices wrap around
+  }
+  else
+  {
+    kept[0] = kept[count - 1] = true;
+    stack = { { 0, count - 1 } };
+  }
+
+  while (!stack.empty())
+  {
+    size_t first = stack.back().first;
+    size_t last = stack.back().second;
+    stack.pop_back();
+
+    CurvePoint a = ToCurvePoint(p[first % count]);
+    CurvePoint b = ToCurvePoint(p[last % count]);
+    double worst = 0.0;
+    size_t index = first;
+    for (size_t i = first + 1; i < last; i++)
+    {
+      double d = SegmentDistance(ToCurvePoint(p[i % count]), a, b);
+      if (d > worst)
+      {
+        worst = d;
+        index = i;
+      }
+    }
+
+    if (worst > tolerance)
+    {
+      kept[index % count] = true;
+      stack.push_back({ first, index });
+      stack.push_back({ index, last });
+    }
+  }
+
+  for (size_t i = 0; i < count; i++)
+    if (kept[i])
+      keep.push_back(i);
+}
+
+#endif // POV_CURVE_H__
@@ -0,0 +1,193 @@
+//------------------------------------------------------------------------
+// Number formatting for SDL output
+//
+// All emitters format their numbers through these functions instead of
+// printf-style format strings. Floats are written either as the shortest
+// text that round-trips (std::to_chars, Ryu based), with a fixed number
+// of decimals, or snapped to a quantization grid. Trailing zeros are
+// always trimmed.
+//------------------------------------------------------------------------
+#ifndef POV_FORMAT_H__
+#define POV_FORMAT_H__
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+enum FloatMode
+{
+  FLOAT_SHORTEST,   // shortest round-trip representation
+  FLOAT_FIXED,      // 'precision' digits after the point
+  FLOAT_QUANTIZED,  // snapped to multiples of 'quantum'
+};
+
+struct NumberFormat
+{
+  FloatMode mode = FLOAT_FIXED;
+  int precision = 6;
+  double quantum = 0.0;
+
+  NumberFormat() = default;
+  NumberFormat(FloatMode m, int p, double q = 0.0) : mode(m), precision(p), quantum(q) {}
+};
+
+// Upper bound of characters written by one FormatInt/FormatFloat call
+const size_t MAX_NUMBER_CHARS = 48;
+
+// Upper bound of characters written by one FormatVec3 call
+const size_t MAX_VECTOR_CHARS = 3 * MAX_NUMBER_CHARS + 8;
+
+//
+// Integer
+//
+inline char* FormatInt(char* out, long long v)
+{
+  return std::to_chars(out, out + MAX_NUMBER_CHARS, v).ptr;
+}
+
+//
+// Remove trailing zeros (and a dangling point) of a fixed notation number
+//
+inline char* TrimFraction(char* begin, char* end)
+{
+  char* dot = (char*)memchr(begin, '.', end - begin);
+  if (!dot)
+    return end;
+
+  while (end > dot + 1 && end[-1] == '0')
+    end--;
+  if (end == dot + 1)
+    end = dot;
+
+  // "-0" -> "0"
+  if (end - begin == 2 && begin[0] == '-' && begin[1] == '0')
+  {
+    begin[0] = '0';
+    end = begin + 1;
+  }
+  return end;
+}
+
+//
+// Number of decimals needed to represent multiples of 'quantum': the
+// smallest d with quantum * 10^d an integer, 0.25 needs 2. The tolerance
+// is relative, quanta below 1e-9 need their digits too.
+//
+inline int QuantumDigits(double quantum)
+{
+  int digits = 0;
+  double scaled = quantum;
+  while (digits < 17 && std::fabs(scaled - std::round(scaled)) > 1e-9 * scaled)
+  {
+    scaled *= 10.0;
+    digits++;
+  }
+  return digits;
+}
+
+//
+// Float
+//
+inline char* FormatFloat(char* out, double v, const NumberFormat& f)
+{
+  char* last = out + MAX_NUMBER_CHARS;
+
+  // SDL has no literal for inf/nan
+  if (!std::isfinite(v))
+  {
+    *out = '0';
+    return out + 1;
+  }
+
+  if (f.mode == FLOAT_QUANTIZED && f.quantum > 0.0)
+  {
+    v = std::round(v / f.quantum) * f.quantum;
+    if (std::fabs(v) < 1e15)
+      return TrimFraction(out, std::to_chars(out, last, v, std::chars_format::fixed, QuantumDigits(f.quantum)).ptr);
+  }
+  else if (f.mode == FLOAT_FIXED && std::fabs(v) < 1e15)
+  {
+    return TrimFraction(out, std::to_chars(out, last, v, std::chars_format::fixed, f.precision).ptr);
+  }
+
+  if (v == 0.0)
+    v = 0.0; // drop the sign of -0
+
+  return std::to_chars(out, last, v).ptr;
+}
+
+//
+// 2D vector: <x, y>
+//
+inline char* FormatVec2(char* out, double x, double y, const NumberFormat& f)
+{
+  *out++ = '<';
+  out = FormatFloat(out, x, f);
+  *out++ = ',';
+  *out++ = ' ';
+  out = FormatFloat(out, y, f);
+  *out++ = '>';
+  return out;
+}
+
+//
+// 3D vector: <x, y, z>
+//
+inline char* FormatVec3(char* out, double x, double y, double z, const NumberFormat& f)
+{
+  *out++ = '<';
+  out = FormatFloat(out, x, f);
+  *out++ = ',';
+  *out++ = ' ';
+  out = FormatFloat(out, y, f);
+  *out++ = ',';
+  *out++ = ' ';
+  out = FormatFloat(out, z, f);
+  *out++ = '>';
+  return out;
+}
+
+//
+// Integer triple: <a, b, c>
+//
+inline char* FormatIndex3(char* out, long long a, long long b, long long c)
+{
+  *out++ = '<';
+  out = FormatInt(out, a);
+  *out++ = ',';
+  *out++ = ' ';
+  out = FormatInt(out, b);
+  *out++ = ',';
+  *out++ = ' ';
+  out = FormatInt(out, c);
+  *out++ = '>';
+  return out;
+}
+
+//
+// Lines of mesh2 lists: "<x, y, z>\n", "<u, v>\n", "<a, b, c>\n"
+//
+const size_t MAX_LINE_CHARS = MAX_VECTOR_CHARS + 1;
+
+inline char* FormatVec2Line(char* out, double x, double y, const NumberFormat& f)
+{
+  out = FormatVec2(out, x, y, f);
+  *out++ = '\n';
+  return out;
+}
+
+inline char* FormatVec3Line(char* out, double x, double y, double z, const NumberFormat& f)
+{
+  out = FormatVec3(out, x, y, z, f);
+  *out++ = '\n';
+  return out;
+}
+
+inline char* FormatIndex3Line(char* out, long long a, long long b, long long c)
+{
+  out = FormatIndex3(out, a, b, c);
+  *out++ = '\n';
+  return out;
+}
+
+#endif // POV_FORMAT_H__
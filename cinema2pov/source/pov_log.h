@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------
+// Leveled logging
+//
+// Messages are written with LogError/LogWarn/LogInfo/LogTrace. Levels
+// above POV_LOG_MAX_LEVEL are compiled out; levels above the runtime
+// level (--log-level) cost one comparison and their arguments are not
+// evaluated. Dump functions check LogEnabled() once on entry.
+//
+// Errors and warnings go to stderr, other messages to stdout. Until
+// LogStart() is called lines are written directly, afterwards they are
+// queued and written by a background thread. LogStop() writes what is
+// left.
+//------------------------------------------------------------------------
+#ifndef POV_LOG_H__
+#define POV_LOG_H__
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+enum LogLevel
+{
+  LOG_ERROR,
+  LOG_WARN,
+  LOG_INFO,
+  LOG_TRACE,
+};
+
+// Most verbose level compiled in, e.g. /DPOV_LOG_MAX_LEVEL=LOG_INFO
+#ifndef POV_LOG_MAX_LEVEL
+#define POV_LOG_MAX_LEVEL LOG_TRACE
+#endif
+
+inline LogLevel g_logLevel = LOG_INFO;
+
+inline bool LogEnabled(LogLevel level)
+{
+  return level <= POV_LOG_MAX_LEVEL && level <= g_logLevel;
+}
+
+//
+// Level by name: error, warn, info, trace. Returns false if unknown.
+//
+inline bool ParseLogLevel(const char* name, LogLevel& level)
+{
+  static const char* names[] = { "error", "warn", "info", "trace" };
+  for (int i = 0; i <= LOG_TRACE; i++)
+    if (!strcmp(name, names[i]))
+    {
+      level = (LogLevel)i;
+      return true;
+    }
+  return false;
+}
+
+class LogSink
+{
+public:
+  static LogSink& Get()
+  {
+    static LogSink sink;
+    return sink;
+  }
+
+  void Start()
+  {
+    if (writer.joinable())
+      return;
+    stop = false;
+    writer = std::thread(&LogSink::WriterLoop, this);
+  }
+
+  void Stop()
+  {
+    if (!writer.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    wake.notify_all();
+    writer.join();
+    fflush(stdout);
+    fflush(stderr);
+  }
+
+  void Write(LogLevel level, const char* data, size_t len)
+  {
+    int s = level <= LOG_WARN ? 1 : 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!writer.joinable())
+    {
+      fwrite(data, 1, len, streams[s]);
+      return;
+    }
+    pending[s].append(data, len);
+    wake.notify_all();
+  }
+
+private:
+  ~LogSink()
+  {
+    Stop();
+  }
+
+  void WriterLoop()
+  {
+    std::string batch[2];
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+      wake.wait(lock, [this] { return stop || !pending[0].empty() || !pending[1].empty(); });
+      if (pending[0].empty() && pending[1].empty())
+        return;
+
+      batch[0].swap(pending[0]);
+      batch[1].swap(pending[1]);
+      lock.unlock();
+      for (int s = 0; s < 2; s++)
+      {
+        fwrite(batch[s].data(), 1, batch[s].size(), streams[s]);
+        batch[s].clear();
+      }
+      lock.lock();
+    }
+  }
+
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable wake;
+  FILE* const streams[2] = { stdout, stderr };
+  std::string pending[2];  // by stream
+  bool stop = false;
+};
+
+inline void LogStart() { LogSink::Get().Start(); }
+inline void LogStop() { LogSink::Get().Stop(); }
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+inline void LogWrite(LogLevel level, const char* fmt, ...)
+{
+  char buf[1024];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0)
+    return;
+
+  if ((size_t)len < sizeof(buf))
+  {
+    LogSink::Get().Write(level, buf, len);
+    return;
+  }
+
+  // Long message
+  std::string big(len + 1, '\0');
+  va_start(args, fmt);
+  vsnprintf(&big[0], big.size(), fmt, args);
+  va_end(args);
+  LogSink::Get().Write(level, big.data(), len);
+}
+
+#define POV_LOG(level, ...) do { if (LogEnabled(level)) LogWrite(level, __VA_ARGS__); } while (0)
+
+#define LogError(...) POV_LOG(LOG_ERROR, __VA_ARGS__)
+#define LogWarn(...)  POV_LOG(LOG_WARN, __VA_ARGS__)
+#define LogInfo(...)  POV_LOG(LOG_INFO, __VA_ARGS__)
+#define LogTrace(...) POV_LOG(LOG_TRACE, __VA_ARGS__)
+
+#endif // POV_LOG_H__
@@ -0,0 +1,801 @@
+//------------------------------------------------------------------------
+// Mesh processing for mesh2 output
+//
+// Polygons are converted into triangles before writing: one triangle per
+// C4D triangle, two per quad (split along the shorter diagonal) and
+// n - 2 per N-gon outline (fan for convex outlines, ear clipping
+// otherwise). Each triangle corner keeps its polygon corner index
+// (polygon * 4 + slot), the layout of C4D per-corner data such as Phong
+// normals.
+//
+// Before writing, coincident points are welded through a spatial hash,
+// collapsed triangles and points no triangle refers to are dropped.
+// Per-corner normals and UVs are deduplicated into tables indexed per
+// triangle.
+//
+// Optionally points and triangles are sorted along a Morton (Z-order)
+// curve for spatial locality of the written lists.
+//
+// Proxy meshes are made by quadric error metric edge collapse
+// (Garland & Heckbert) of the welded triangles.
+//
+// Point type P needs x, y, z members (cineware::Vector).
+//------------------------------------------------------------------------
+#ifndef POV_MESH_H__
+#define POV_MESH_H__
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <algorithm>
+
+struct MeshTriangle
+{
+  int v[3];       // point indices
+  int corner[3];  // polygon corner indices: polygon * 4 + slot
+};
+
+//
+// 64-bit content hash
+//
+inline uint64_t HashBytes(const void* data, size_t len, uint64_t seed)
+{
+  const unsigned char* p = (const unsigned char*)data;
+  uint64_t h = seed ^ (len * 0x9E3779B97F4A7C15ull);
+  auto mix = [&h](uint64_t w)
+  {
+    w *= 0xBF58476D1CE4E5B9ull;
+    w ^= w >> 31;
+    h = (h ^ w) * 0x94D049BB133111EBull;
+    h ^= h >> 29;
+  };
+
+  for (; len >= 8; p += 8, len -= 8)
+  {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    mix(w);
+  }
+  if (len > 0)
+  {
+    uint64_t w = 0;
+    memcpy(&w, p, len);
+    mix(w);
+  }
+  return h;
+}
+
+//
+// Geometry helpers
+//
+template <class P>
+inline double DistanceSq(const P& a, const P& b)
+{
+  double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+inline void AddTriangle(std::vector<MeshTriangle>& tris, int a, int b, int c, int ca, int cb, int cc)
+{
+  MeshTriangle t = { { a, b, c }, { ca, cb, cc } };
+  tris.push_back(t);
+}
+
+//
+// Triangulate one C4D polygon (a, b, c, d; c == d for triangles)
+//
+template <class P>
+inline void TriangulatePolygon(const P* points, int poly, int a, int b, int c, int d, std::vector<MeshTriangle>& tris)
+{
+  int base = poly * 4;
+  if (c == d)
+  {
+    AddTriangle(tris, a, b, c, base, base + 1, base + 2);
+    return;
+  }
+
+  // Split along the shorter diagonal, a-c on ties
+  if (DistanceSq(points[a], points[c]) <= DistanceSq(points[b], points[d]))
+  {
+    AddTriangle(tris, a, b, c, base, base + 1, base + 2);
+    AddTriangle(tris, a, c, d, base, base + 2, base + 3);
+  }
+  else
+  {
+    AddTriangle(tris, a, b, d, base, base + 1, base + 3);
+    AddTriangle(tris, b, c, d, base + 1, base + 2, base + 3);
+  }
+}
+
+//
+// Triangulate a closed outline given by point and corner indices.
+// Returns false (adding nothing) when the outline can't be triangulated.
+//
+template <class P>
+inline bool TriangulateOutline(const P* points, const std::vector<int>& verts, const std::vector<int>& corners, std::vector<MeshTriangle>& tris)
+{
+  int n = (int)verts.size();
+  if (n < 3)
+    return false;
+
+  // Outline normal (Newell), project onto the plane of its dominant axis
+  double nx = 0, ny = 0, nz = 0;
+  for (int i = 0; i < n; i++)
+  {
+    const P& p = points[verts[i]];
+    const P& q = points[verts[(i + 1) % n]];
+    nx += (p.y - q.y) * (p.z + q.z);
+    ny += (p.z - q.z) * (p.x + q.x);
+    nz += (p.x - q.x) * (p.y + q.y);
+  }
+
+  double ax = std::fabs(nx), ay = std::fabs(ny), az = std::fabs(nz);
+  if (ax + ay + az == 0.0)
+    return false;
+
+  int axis = (ax >= ay && ax >= az) ? 0 : (ay >= az ? 1 : 2);
+  double sign = (axis == 0 ? nx : (axis == 1 ? ny : nz)) > 0 ? 1.0 : -1.0;
+
+  std::vector<double> u(n), v(n);
+  for (int i = 0; i < n; i++)
+  {
+    const P& p = points[verts[i]];
+    switch (axis)
+    {
+      case 0: u[i] = p.y; v[i] = p.z; break;
+      case 1: u[i] = p.z; v[i] = p.x; break;
+      case 2: u[i] = p.x; v[i] = p.y; break;
+    }
+  }
+
+  // Twice the signed area of (i, j, k), positive for the outline winding
+  auto cross = [&](int i, int j, int k)
+  {
+    return sign * ((u[j] - u[i]) * (v[k] - v[i]) - (v[j] - v[i]) * (u[k] - u[i]));
+  };
+
+  // Convex outline: fan
+  bool convex = true;
+  for (int i = 0; i < n && convex; i++)
+    convex = cross(i, (i + 1) % n, (i + 2) % n) > 0.0;
+
+  size_t first = tris.size();
+  if (convex)
+  {
+    for (int i = 1; i < n - 1; i++)
+      AddTriangle(tris, verts[0], verts[i], verts[i + 1], corners[0], corners[i], corners[i + 1]);
+    return true;
+  }
+
+  // Ear clipping
+  std::vector<int> prev(n), next(n);
+  for (int i = 0; i < n; i++)
+  {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+  }
+
+  int left = n;
+  int i = 0;
+  int misses = 0;
+  while (left > 3)
+  {
+    int a = prev[i], c = next[i];
+    bool ear = cross(a, i, c) > 0.0;
+
+    // No other outline point inside the candidate ear
+    for (int j = next[c]; ear && j != a; j = next[j])
+    {
+      if (verts[j] == verts[a] || verts[j] == verts[i] || verts[j] == verts[c])
+        continue;
+      ear = !(cross(a, i, j) >= 0.0 && cross(i, c, j) >= 0.0 && cross(c, a, j) >= 0.0);
+    }
+
+    if (ear)
+    {
+      AddTriangle(tris, verts[a], verts[i], verts[c], corners[a], corners[i], corners[c]);
+      next[a] = c;
+      prev[c] = a;
+      left--;
+      misses = 0;
+      i = c;
+    }
+    else if (++misses > left)
+    {
+      tris.resize(first);
+      return false;
+    }
+    else
+      i = c;
+  }
+
+  AddTriangle(tris, verts[prev[i]], verts[i], verts[next[i]], corners[prev[i]], corners[i], corners[next[i]]);
+  return true;
+}
+
+//
+// Weld points closer than 'epsilon' (exact duplicates only for 0, no
+// welding for negative values) and drop points without triangles.
+// Triangle point indices are remapped; 'used' receives the original
+// index of each remaining point. Returns the number of welded points.
+//
+template <class P>
+inline int WeldPoints(const P* points, int count, double epsilon, std::vector<MeshTriangle>& tris, std::vector<int>& used)
+{
+  std::vector<int> target(count);
+  for (int i = 0; i < count; i++)
+    target[i] = i;
+
+  int welded = 0;
+  if (epsilon >= 0.0)
+  {
+    // Spatial hash: cells of size epsilon, points chained per cell
+    double cell = epsilon > 0.0 ? epsilon : 1.0;
+    double epsSq = epsilon * epsilon;
+    int range = epsilon > 0.0 ? 1 : 0;
+
+    auto cellKey = [](int64_t x, int64_t y, int64_t z)
+    {
+      return (uint64_t)x * 73856093ull ^ (uint64_t)y * 19349663ull ^ (uint64_t)z * 83492791ull;
+    };
+
+    std::unordered_map<uint64_t, int> head;
+    std::vector<int> chain(count, -1);
+    head.reserve(count);
+
+    for (int i = 0; i < count; i++)
+    {
+      const P& p = points[i];
+      int64_t cx = (int64_t)std::floor(p.x / cell);
+      int64_t cy = (int64_t)std::floor(p.y / cell);
+      int64_t cz = (int64_t)std::floor(p.z / cell);
+
+      // First earlier point within epsilon in the neighbouring cells
+      int found = -1;
+      for (int dx = -range; dx <= range && found < 0; dx++)
+        for (int dy = -range; dy <= range && found < 0; dy++)
+          for (int dz = -range; dz <= range && found < 0; dz++)
+          {
+            auto it = head.find(cellKey(cx + dx, cy + dy, cz + dz));
+            if (it == head.end())
+              continue;
+            for (int j = it->second; j >= 0; j = chain[j])
+              if (DistanceSq(points[j], p) <= epsSq)
+              {
+                found = j;
+                break;
+              }
+          }
+
+      if (found >= 0)
+      {
+        target[i] = found;
+        welded++;
+        continue;
+      }
+
+      auto ins = head.emplace(cellKey(cx, cy, cz), i);
+      if (!ins.second)
+      {
+        chain[i] = ins.first->second;
+        ins.first->second = i;
+      }
+    }
+  }
+
+  // Drop triangles collapsed by welding
+  size_t kept = 0;
+  for (const MeshTriangle& t : tris)
+  {
+    int a = target[t.v[0]], b = target[t.v[1]], c = target[t.v[2]];
+    if (a == b || b == c || c == a)
+      continue;
+    MeshTriangle& k = tris[kept++];
+    k = t;
+    k.v[0] = a;
+    k.v[1] = b;
+    k.v[2] = c;
+  }
+  tris.resize(kept);
+
+  // Compact referenced points, keeping their original order
+  std::vector<int> index(count, -1);
+  for (const MeshTriangle& t : tris)
+    for (int k = 0; k < 3; k++)
+      index[t.v[k]] = 0;
+
+  used.clear();
+  for (int i = 0; i < count; i++)
+    if (index[i] == 0)
+    {
+      index[i] = (int)used.size();
+      used.push_back(i);
+    }
+
+  for (MeshTriangle& t : tris)
+    for (int k = 0; k < 3; k++)
+      t.v[k] = index[t.v[k]];
+
+  return welded;
+}
+
+//
+// Deduplicate per-corner data (normals, UVs; indexed by polygon corner)
+// used by the triangles. 'table' receives the corner index of each unique
+// value, 'indices' three table indices per triangle.
+//
+struct CornerKey
+{
+  double x, y, z;
+  bool operator==(const CornerKey& k) const { return x == k.x && y == k.y && z == k.z; }
+};
+
+struct CornerKeyHash
+{
+  size_t operator()(const CornerKey& k) const
+  {
+    uint64_t b[3];
+    memcpy(b, &k, sizeof(b));
+    uint64_t h = b[0] * 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 29) ^ b[1]) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 32) ^ b[2]) * 0x94D049BB133111EBull;
+    return (size_t)(h ^ (h >> 31));
+  }
+};
+
+template <class N>
+inline void IndexCorners(const N* data, const std::vector<MeshTriangle>& tris, std::vector<int>& table, std::vector<int>& indices)
+{
+  std::unordered_map<CornerKey, int, CornerKeyHash> index;
+  index.reserve(tris.size());
+  table.clear();
+  indices.resize(tris.size() * 3);
+
+  for (size_t i = 0; i < tris.size(); i++)
+    for (int k = 0; k < 3; k++)
+    {
+      int corner = tris[i].corner[k];
+      const N& n = data[corner];
+
+      // + 0.0 folds -0 into 0
+      CornerKey key = { n.x + 0.0, n.y + 0.0, n.z + 0.0 };
+      auto it = index.emplace(key, (int)table.size());
+      if (it.second)
+        table.push_back(corner);
+      indices[i * 3 + k] = it.first->second;
+    }
+}
+
+//
+// Morton order
+//
+
+// Spread the lower 21 bits of v to every third bit
+inline uint64_t MortonSpread(uint64_t v)
+{
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffull;
+  v = (v | v << 16) & 0x1f0000ff0000ffull;
+  v = (v | v << 8) & 0x100f00f00f00f00full;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+  v = (v | v << 2) & 0x1249249249249249ull;
+  return v;
+}
+
+// Morton code of a position in the box (lo, scale = 2^21 - 1 / size)
+inline uint64_t MortonCode(double x, double y, double z, const double lo[3], const double scale[3])
+{
+  auto q = [](double v) { return (uint64_t)(v < 0.0 ? 0.0 : (v > 2097151.0 ? 2097151.0 : v)); };
+  return MortonSpread(q((x - lo[0]) * scale[0]))
+       | MortonSpread(q((y - lo[1]) * scale[1])) << 1
+       | MortonSpread(q((z - lo[2]) * scale[2])) << 2;
+}
+
+//
+// Sort points (given by 'used', original indices) by the Morton code of
+// their position and triangles by the code of their centroid. Triangle
+// point indices are remapped, corners are kept; the sort is stable.
+//
+template <class P>
+inline void MortonOrder(const P* points, std::vector<int>& used, std::vector<MeshTriangle>& tris)
+{
+  size_t pc = used.size();
+  if (pc == 0)
+    return;
+
+  double lo[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL }, hi[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+  for (int i : used)
+  {
+    const P& p = points[i];
+    double c[3] = { p.x, p.y, p.z };
+    for (int k = 0; k < 3; k++)
+    {
+      lo[k] = std::min(lo[k], c[k]);
+      hi[k] = std::max(hi[k], c[k]);
+    }
+  }
+
+  double scale[3];
+  for (int k = 0; k < 3; k++)
+    scale[k] = hi[k] > lo[k] ? 2097151.0 / (hi[k] - lo[k]) : 0.0;
+
+  // Points
+  std::vector<std::pair<uint64_t, int>> order(pc);
+  for (size_t i = 0; i < pc; i++)
+  {
+    const P& p = points[used[i]];
+    order[i] = { MortonCode(p.x, p.y, p.z, lo, scale), (int)i };
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<int> index(pc), sorted(pc);
+  for (size_t i = 0; i < pc; i++)
+  {
+    index[order[i].second] = (int)i;
+    sorted[i] = used[order[i].second];
+  }
+  used.swap(sorted);
+
+  // Triangles
+  std::vector<std::pair<uint64_t, int>> torder(tris.size());
+  for (size_t t = 0; t < tris.size(); t++)
+  {
+    double c[3] = { 0, 0, 0 };
+    for (int k = 0; k < 3; k++)
+    {
+      const P& p = points[used[index[tris[t].v[k]]]];
+      c[0] += p.x / 3.0;
+      c[1] += p.y / 3.0;
+      c[2] += p.z / 3.0;
+    }
+    torder[t] = { MortonCode(c[0], c[1], c[2], lo, scale), (int)t };
+  }
+  std::sort(torder.begin(), torder.end());
+
+  std::vector<MeshTriangle> stris(tris.size());
+  for (size_t t = 0; t < tris.size(); t++)
+  {
+    MeshTriangle& st = stris[t];
+    st = tris[torder[t].second];
+    for (int k = 0; k < 3; k++)
+      st.v[k] = index[st.v[k]];
+  }
+  tris.swap(stris);
+}
+
+//
+// Quadric error metric decimation
+//
+struct MeshPoint
+{
+  double x, y, z;
+};
+
+// Symmetric 4x4 matrix: a2 ab ac ad b2 bc bd c2 cd d2
+struct Quadric
+{
+  double q[10] = { 0 };
+  double area = 0.0;    // of the face planes, Error() / area is a squared distance
+
+  void AddPlane(double a, double b, double c, double d, double w)
+  {
+    q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+    q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+    q[7] += w * c * c; q[8] += w * c * d;
+    q[9] += w * d * d;
+  }
+
+  void Add(const Quadric& o)
+  {
+    for (int i = 0; i < 10; i++)
+      q[i] += o.q[i];
+    area += o.area;
+  }
+
+  double Error(const MeshPoint& p) const
+  {
+    double x = p.x, y = p.y, z = p.z;
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+         + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+         + q[7] * z * z + 2 * q[8] * z + q[9];
+  }
+
+  // Point of minimal error, false if the system is singular
+  bool Optimum(MeshPoint& p) const
+  {
+    double det = q[0] * (q[4] * q[7] - q[5] * q[5]) - q[1] * (q[1] * q[7] - q[5] * q[2]) + q[2] * (q[1] * q[5] - q[4] * q[2]);
+    double scale = q[0] * q[4] * q[7];
+    if (std::fabs(det) <= 1e-12 * std::fabs(scale) || det == 0.0)
+      return false;
+
+    double i00 = q[4] * q[7] - q[5] * q[5], i01 = q[2] * q[5] - q[1] * q[7], i02 = q[1] * q[5] - q[2] * q[4];
+    double i11 = q[0] * q[7] - q[2] * q[2], i12 = q[1] * q[2] - q[0] * q[5];
+    double i22 = q[0] * q[4] - q[1] * q[1];
+    p.x = -(i00 * q[3] + i01 * q[6] + i02 * q[8]) / det;
+    p.y = -(i01 * q[3] + i11 * q[6] + i12 * q[8]) / det;
+    p.z = -(i02 * q[3] + i12 * q[6] + i22 * q[8]) / det;
+    return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+  }
+};
+
+inline MeshPoint TriangleNormal(const MeshPoint& a, const MeshPoint& b, const MeshPoint& c)
+{
+  double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+  double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+  MeshPoint n = { uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+  return n;
+}
+
+//
+// Collapse edges of least quadric error until the triangle count drops
+// to 'ratio' of the original, or the next collapse would move the surface
+// by more than 'maxError' (0 - no limit): the area weighted RMS distance
+// of the new point to the planes of the merged triangles. Boundary edges
+// are kept in place by perpendicular penalty planes; collapses flipping a
+// triangle or breaking the link condition (the surface would become
+// non-manifold) are rejected. Points and triangles are compacted
+// afterwards, triangle corner indices are not kept. Returns the number
+// of collapses.
+//
+inline int DecimateMesh(std::vector<MeshPoint>& pts, std::vector<MeshTriangle>& tris, double ratio, double maxError)
+{
+  int pc = (int)pts.size();
+  int tc = (int)tris.size();
+  int target = (int)(tc * ratio);
+  double errorLimit = maxError > 0.0 ? maxError * maxError : HUGE_VAL;
+
+  std::vector<Quadric> quadrics(pc);
+  std::vector<std::vector<int>> pointTris(pc);
+  std::vector<char> deadTri(tc, 0), deadPoint(pc, 0);
+  std::vector<unsigned> stamp(pc, 0);
+
+  // Face quadrics, area weighted
+  for (int t = 0; t < tc; t++)
+  {
+    const int* v = tris[t].v;
+    MeshPoint n = TriangleNormal(pts[v[0]], pts[v[1]], pts[v[2]]);
+    double len = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+    if (len > 0.0)
+    {
+      double a = n.x / len, b = n.y / len, c = n.z / len;
+      double d = -(a * pts[v[0]].x + b * pts[v[0]].y + c * pts[v[0]].z);
+      for (int k = 0; k < 3; k++)
+      {
+        quadrics[v[k]].AddPlane(a, b, c, d, len * 0.5);
+        quadrics[v[k]].area += len * 0.5;
+      }
+    }
+    for (int k = 0; k < 3; k++)
+      pointTris[v[k]].push_back(t);
+  }
+
+  // Edges with their triangle count; boundary edges get penalty planes
+  auto edgeKey = [](int a, int b) { return a < b ? ((uint64_t)a << 32) | (uint32_t)b : ((uint64_t)b << 32) | (uint32_t)a; };
+  std::unordered_map<uint64_t, int> edges;
+  edges.reserve((size_t)tc * 3);
+  for (int t = 0; t < tc; t++)
+    for (int k = 0; k < 3; k++)
+      edges[edgeKey(tris[t].v[k], tris[t].v[(k + 1) % 3])]++;
+
+  std::vector<char> boundary(pc, 0);
+  for (int t = 0; t < tc; t++)
+  {
+    const int* v = tris[t].v;
+    MeshPoint n = TriangleNormal(pts[v[0]], pts[v[1]], pts[v[2]]);
+    for (int k = 0; k < 3; k++)
+    {
+      int a = v[k], b = v[(k + 1) % 3];
+      if (edges[edgeKey(a, b)] != 1)
+        continue;
+      boundary[a] = boundary[b] = 1;
+
+      // Plane through the edge, perpendicular to the triangle
+      double ex = pts[b].x - pts[a].x, ey = pts[b].y - pts[a].y, ez = pts[b].z - pts[a].z;
+      MeshPoint p = { ey * n.z - ez * n.y, ez * n.x - ex * n.z, ex * n.y - ey * n.x };
+      double len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+      if (len == 0.0)
+        continue;
+      p.x /= len; p.y /= len; p.z /= len;
+      double d = -(p.x * pts[a].x + p.y * pts[a].y + p.z * pts[a].z);
+      double w = 1000.0 * (ex * ex + ey * ey + ez * ez);
+      quadrics[a].AddPlane(p.x, p.y, p.z, d, w);
+      quadrics[b].AddPlane(p.x, p.y, p.z, d, w);
+    }
+  }
+
+  // Candidate collapses, invalidated through point stamps
+  struct Candidate
+  {
+    double cost;
+    int a, b;
+    unsigned sa, sb;
+    MeshPoint p;
+    bool operator<(const Candidate& o) const { return cost > o.cost; }
+  };
+  std::priority_queue<Candidate> heap;
+
+  auto push = [&](int a, int b)
+  {
+    Quadric q = quadrics[a];
+    q.Add(quadrics[b]);
+
+    MeshPoint mid = { (pts[a].x + pts[b].x) * 0.5, (pts[a].y + pts[b].y) * 0.5, (pts[a].z + pts[b].z) * 0.5 };
+    MeshPoint best = mid;
+    double cost = q.Error(mid);
+
+    MeshPoint opt;
+    if (q.Optimum(opt))
+    {
+      double e = q.Error(opt);
+      if (e < cost) { best = opt; cost = e; }
+    }
+    for (int v : { a, b })
+    {
+      double e = q.Error(pts[v]);
+      if (e < cost) { best = pts[v]; cost = e; }
+    }
+    // Squared distance, comparable to the limit
+    if (q.area > 0.0)
+      cost /= q.area;
+    heap.push({ std::max(cost, 0.0), a, b, stamp[a], stamp[b], best });
+  };
+
+  for (const auto& e : edges)
+    push((int)(e.first >> 32), (int)(e.first & 0xffffffff));
+
+  // Collapsing a-b to p must not flip any remaining triangle
+  auto flips = [&](int v, int other, const MeshPoint& p)
+  {
+    for (int t : pointTris[v])
+    {
+      if (deadTri[t])
+        continue;
+      const int* tv = tris[t].v;
+      if (tv[0] == other || tv[1] == other || tv[2] == other)
+        continue;
+
+      MeshPoint q[3];
+      for (int k = 0; k < 3; k++)
+        q[k] = tv[k] == v ? p : pts[tv[k]];
+      MeshPoint before = TriangleNormal(pts[tv[0]], pts[tv[1]], pts[tv[2]]);
+      MeshPoint after = TriangleNormal(q[0], q[1], q[2]);
+      if (before.x * after.x + before.y * after.y + before.z * after.z <= 0.0)
+        return true;
+    }
+    return false;
+  };
+
+  // Link condition: the common neighbors of a and b are exactly the
+  // opposite corners of the triangles on edge a-b, and an inner edge
+  // doesn't join two boundary points
+  std::vector<int> na, nb;
+  auto linked = [&](int a, int b)
+  {
+    int shared = 0;
+    na.clear();
+    nb.clear();
+    for (int t : pointTris[a])
+    {
+      if (deadTri[t])
+        continue;
+      const int* tv = tris[t].v;
+      if (tv[0] == b || tv[1] == b || tv[2] == b)
+        shared++;
+      for (int k = 0; k < 3; k++)
+        if (tv[k] != a)
+          na.push_back(tv[k]);
+    }
+    for (int t : pointTris[b])
+      if (!deadTri[t])
+        for (int k = 0; k < 3; k++)
+          if (tris[t].v[k] != b)
+            nb.push_back(tris[t].v[k]);
+
+    std::sort(na.begin(), na.end());
+    na.erase(std::unique(na.begin(), na.end()), na.end());
+    std::sort(nb.begin(), nb.end());
+    nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+    int common = 0;
+    for (size_t i = 0, j = 0; i < na.size() && j < nb.size();)
+    {
+      if (na[i] < nb[j])
+        i++;
+      else if (nb[j] < na[i])
+        j++;
+      else
+      {
+        common++;
+        i++;
+        j++;
+      }
+    }
+    return common == shared && !(boundary[a] && boundary[b] && shared != 1);
+  };
+
+  int alive = tc;
+  int collapses = 0;
+  while (alive > target && !heap.empty())
+  {
+    Candidate c = heap.top();
+    heap.pop();
+
+    if (deadPoint[c.a] || deadPoint[c.b] || stamp[c.a] != c.sa || stamp[c.b] != c.sb)
+      continue;
+    if (c.cost > errorLimit)
+      break;
+    if (flips(c.a, c.b, c.p) || flips(c.b, c.a, c.p) || !linked(c.a, c.b))
+      continue;
+
+    // Collapse b into a
+    int a = c.a, b = c.b;
+    pts[a] = c.p;
+    quadrics[a].Add(quadrics[b]);
+    boundary[a] |= boundary[b];
+    deadPoint[b] = 1;
+    stamp[a]++;
+
+    for (int t : pointTris[b])
+    {
+      if (deadTri[t])
+        continue;
+      int* tv = tris[t].v;
+      if (tv[0] == a || tv[1] == a || tv[2] == a)
+      {
+        deadTri[t] = 1;
+        alive--;
+        continue;
+      }
+      for (int k = 0; k < 3; k++)
+        if (tv[k] == b)
+          tv[k] = a;
+      pointTris[a].push_back(t);
+    }
+    pointTris[b].clear();
+
+    // Drop dead triangles from a, re-queue its edges
+    std::vector<int>& at = pointTris[a];
+    at.erase(std::remove_if(at.begin(), at.end(), [&](int t) { return deadTri[t] != 0; }), at.end());
+
+    std::vector<int> ring;
+    for (int t : at)
+      for (int k = 0; k < 3; k++)
+        if (tris[t].v[k] != a)
+          ring.push_back(tris[t].v[k]);
+    std::sort(ring.begin(), ring.end());
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    for (int v : ring)
+      push(a, v);
+    collapses++;
+  }
+
+  // Compact
+  std::vector<int> index(pc, -1);
+  std::vector<MeshPoint> kept;
+  size_t kt = 0;
+  for (int t = 0; t < tc; t++)
+  {
+    if (deadTri[t])
+      continue;
+    MeshTriangle& nt = tris[kt++];
+    nt = tris[t];
+    for (int k = 0; k < 3; k++)
+    {
+      int& v = nt.v[k];
+      if (index[v] < 0)
+      {
+        index[v] = (int)kept.size();
+        kept.push_back(pts[v]);
+      }
+      v = index[v];
+      nt.corner[k] = -1;
+    }
+  }
+  tris.resize(kt);
+  pts.swap(kept);
+  return collapses;
+}
+
+#endif // POV_MESH_H__
@@ -0,0 +1,554 @@
+//------------------------------------------------------------------------
+// Buffered output sink for SDL data
+//
+// Emitters append to a large user-space buffer; full buffers are written
+// to the file either directly or, in async mode, by a background thread
+// while formatting continues into a spare buffer. On POSIX systems all
+// pending buffers are handed to the kernel with one writev() call.
+//
+// A sink without a file is a growing memory buffer, used to build output
+// fragments that are written to the file sink later. WriteLines() and
+// WriteTasks() use such fragments to format output on several threads.
+//------------------------------------------------------------------------
+#ifndef POV_OUTPUT_H__
+#define POV_OUTPUT_H__
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define POV_OUTPUT_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <limits.h>
+#endif
+
+//
+// Growable byte buffer without value initialization: Reserve() and
+// Resize() don't clear the memory formatters write into
+//
+class OutputBuffer
+{
+public:
+  OutputBuffer() {}
+  OutputBuffer(OutputBuffer&& b) noexcept : data(std::move(b.data)), size(b.size), cap(b.cap)
+  {
+    b.size = b.cap = 0;
+  }
+
+  OutputBuffer& operator=(OutputBuffer&& b) noexcept
+  {
+    data = std::move(b.data);
+    size = b.size;
+    cap = b.cap;
+    b.size = b.cap = 0;
+    return *this;
+  }
+
+  char* Data() { return data.get(); }
+  const char* Data() const { return data.get(); }
+  size_t Size() const { return size; }
+  size_t Capacity() const { return cap; }
+  bool Empty() const { return size == 0; }
+  void Clear() { size = 0; }
+
+  void Reserve(size_t n)
+  {
+    if (n <= cap)
+      return;
+    std::unique_ptr<char[]> p(new char[n]);
+    if (size > 0)
+      memcpy(p.get(), data.get(), size);
+    data = std::move(p);
+    cap = n;
+  }
+
+  // New size, at most the capacity
+  void Resize(size_t n) { size = n; }
+
+  void Append(const char* src, size_t len)
+  {
+    if (size + len > cap)
+      Reserve(std::max(cap * 2, size + len));
+    memcpy(data.get() + size, src, len);
+    size += len;
+  }
+
+private:
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  size_t cap = 0;
+};
+
+class OutputSink
+{
+public:
+  static const size_t DEFAULT_BUFFER_SIZE = 4 << 20;
+  static const size_t ASYNC_BUFFERS = 4;
+
+  explicit OutputSink(size_t bufferSize = DEFAULT_BUFFER_SIZE)
+    : capacity(bufferSize)
+  {
+    current.Reserve(capacity);
+  }
+
+  ~OutputSink()
+  {
+    Close();
+  }
+
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+
+  //
+  // Open file, optionally with background flushing
+  //
+  bool Open(const char* fn, bool async)
+  {
+#ifdef POV_OUTPUT_POSIX
+    fd = open(fn, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+#else
+    // Binary: LF line ends on all platforms, POV-Ray reads both
+    fh = fopen(fn, "wb");
+    if (!fh)
+      return false;
+    setvbuf(fh, nullptr, _IONBF, 0);
+#endif
+    opened = true;
+    error = false;
+    flushed = 0;
+
+    if (async)
+    {
+      spare.clear();
+      queue.clear();
+      for (size_t i = 1; i < ASYNC_BUFFERS; i++)
+      {
+        spare.emplace_back();
+        spare.back().Reserve(capacity);
+      }
+      stop = false;
+      writer = std::thread(&OutputSink::WriterLoop, this);
+    }
+    return true;
+  }
+
+  //
+  // Flush everything and close the file. Returns false on write errors.
+  //
+  bool Close()
+  {
+    if (!opened)
+      return !error;
+
+    Flush();
+    if (writer.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      wake.notify_all();
+      writer.join();
+    }
+
+#ifdef POV_OUTPUT_POSIX
+    close(fd);
+    fd = -1;
+#else
+    fclose(fh);
+    fh = nullptr;
+#endif
+    opened = false;
+    return !error;
+  }
+
+  bool IsFile() const { return opened; }
+
+  //
+  // Append data
+  //
+  void Write(const char* data, size_t len)
+  {
+    if (current.Size() + len > current.Capacity() && opened)
+    {
+      Flush();
+
+      // Large blocks bypass the buffer, in async mode they take a free
+      // buffer like Flush()
+      if (len >= capacity)
+      {
+        bytes += len;
+        if (writer.joinable())
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          done.wait(lock, [this] { return !spare.empty(); });
+          OutputBuffer block = std::move(spare.back());
+          spare.pop_back();
+          block.Clear();
+          block.Append(data, len);
+          queue.push_back(std::move(block));
+          wake.notify_all();
+        }
+        else
+          WriteBlock(data, len);
+        return;
+      }
+    }
+    current.Append(data, len);
+    bytes += len;
+  }
+
+  void Write(const char* str)
+  {
+    Write(str, strlen(str));
+  }
+
+  void Write(const OutputSink& fragment)
+  {
+    Write(fragment.Data(), fragment.Size());
+  }
+
+  //
+  // Direct formatting into the buffer: Reserve() at most 'len' bytes,
+  // format into the returned pointer, then Commit() the end pointer.
+  //
+  char* Reserve(size_t len)
+  {
+    if (current.Size() + len > current.Capacity())
+    {
+      if (opened)
+        Flush();
+      if (current.Size() + len > current.Capacity())
+        current.Reserve((current.Size() + len) * 2);
+    }
+    return current.Data() + current.Size();
+  }
+
+  void Commit(const char* end)
+  {
+    size_t used = end - (current.Data() + current.Size());
+    current.Resize(current.Size() + used);
+    bytes += used;
+  }
+
+  //
+  // Hand the current buffer over to the file
+  //
+  void Flush()
+  {
+    if (!opened || current.Empty())
+      return;
+
+    flushes++;
+    if (!writer.joinable())
+    {
+      WriteBlock(current.Data(), current.Size());
+      current.Clear();
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queue.push_back(std::move(current));
+    wake.notify_all();
+    done.wait(lock, [this] { return !spare.empty(); });
+    current = std::move(spare.back());
+    spare.pop_back();
+    current.Clear();
+  }
+
+  // Memory sink content
+  const char* Data() const { return current.Data(); }
+  size_t Size() const { return current.Size(); }
+  void Clear() { current.Clear(); }
+
+  // Counters
+  unsigned long long BytesWritten() const { return bytes; }
+  unsigned long long BytesFlushed() const { return flushed; }
+  unsigned long long FlushCount() const { return flushes; }
+  bool HasError() const { return error; }
+
+private:
+  void WriteBlock(const char* data, size_t len)
+  {
+#ifdef POV_OUTPUT_POSIX
+    while (len > 0)
+    {
+      ssize_t n = write(fd, data, len);
+      if (n <= 0)
+      {
+        error = true;
+        return;
+      }
+      data += n;
+      len -= n;
+      flushed += n;
+    }
+#else
+    if (fwrite(data, 1, len, fh) != len)
+      error = true;
+    flushed += len;
+#endif
+  }
+
+#ifdef POV_OUTPUT_POSIX
+  // Write a batch of buffers with as few system calls as possible
+  void WriteBlocks(std::vector<OutputBuffer>& blocks)
+  {
+    std::vector<struct iovec> iov;
+    for (auto& b : blocks)
+      iov.push_back({ b.Data(), b.Size() });
+
+    size_t first = 0;
+    while (first < iov.size())
+    {
+      int cnt = (int)std::min(iov.size() - first, (size_t)IOV_MAX);
+      ssize_t n = writev(fd, &iov[first], cnt);
+      if (n <= 0)
+      {
+        error = true;
+        return;
+      }
+      flushed += n;
+
+      // Skip fully written buffers, adjust a partially written one
+      while (first < iov.size() && (size_t)n >= iov[first].iov_len)
+        n -= iov[first++].iov_len;
+      if (n > 0)
+      {
+        iov[first].iov_base = (char*)iov[first].iov_base + n;
+        iov[first].iov_len -= n;
+      }
+    }
+  }
+#else
+  void WriteBlocks(std::vector<OutputBuffer>& blocks)
+  {
+    for (auto& b : blocks)
+      WriteBlock(b.Data(), b.Size());
+  }
+#endif
+
+  void WriterLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+      wake.wait(lock, [this] { return stop || !queue.empty(); });
+      if (queue.empty())
+        return;
+
+      std::vector<OutputBuffer> batch(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+      queue.clear();
+
+      lock.unlock();
+      WriteBlocks(batch);
+      lock.lock();
+
+      // Buffers grown by large blocks are replaced by ones of normal size
+      for (auto& b : batch)
+      {
+        if (spare.size() >= ASYNC_BUFFERS)
+          continue;
+        if (b.Capacity() != capacity)
+        {
+          b = OutputBuffer();
+          b.Reserve(capacity);
+        }
+        spare.push_back(std::move(b));
+      }
+      done.notify_all();
+    }
+  }
+
+  size_t capacity;
+  OutputBuffer current;
+
+  bool opened = false;
+  std::atomic<bool> error{ false };
+#ifdef POV_OUTPUT_POSIX
+  int fd = -1;
+#else
+  FILE* fh = nullptr;
+#endif
+
+  unsigned long long bytes = 0;
+  std::atomic<unsigned long long> flushed{ 0 };
+  unsigned long long flushes = 0;
+
+  // Background flushing
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::deque<OutputBuffer> queue;
+  std::vector<OutputBuffer> spare;
+  bool stop = false;
+};
+
+//
+// Write 'count' numbered lines: format(p, i) writes line i (at most
+// 'maxLine' bytes) to p and returns its end. Long lists are split into
+// chunks formatted by worker threads into memory sinks, which are then
+// appended in order - the output is identical to a serial loop.
+//
+const size_t CHUNK_LINES = 16384;
+
+template <class F>
+inline void WriteLines(OutputSink& out, size_t count, size_t maxLine, unsigned threads, F format)
+{
+  if (threads <= 1 || count < 2 * CHUNK_LINES)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      char* p = out.Reserve(maxLine);
+      out.Commit(format(p, i));
+    }
+    return;
+  }
+
+  // Chunks are formatted in waves to bound the memory held in fragments
+  size_t chunks = (count + CHUNK_LINES - 1) / CHUNK_LINES;
+  size_t wave = (size_t)threads * 4;
+  std::vector<std::unique_ptr<OutputSink>> fragments;
+  for (size_t c = 0; c < std::min(wave, chunks); c++)
+    fragments.emplace_back(new OutputSink(0));
+
+  for (size_t first = 0; first < chunks; first += wave)
+  {
+    size_t last = std::min(first + wave, chunks);
+    std::atomic<size_t> next{ first };
+
+    auto worker = [&]()
+    {
+      for (size_t c; (c = next++) < last;)
+      {
+        OutputSink& frag = *fragments[c - first];
+        size_t begin = c * CHUNK_LINES;
+        size_t end = std::min(begin + CHUNK_LINES, count);
+        char* p = frag.Reserve((end - begin) * maxLine);
+        for (size_t i = begin; i < end; i++)
+          p = format(p, i);
+        frag.Commit(p);
+      }
+    };
+
+    std::vector<std::thread> pool;
+    unsigned n = (unsigned)std::min((size_t)threads, last - first);
+    for (unsigned t = 1; t < n; t++)
+      pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool)
+      t.join();
+
+    for (size_t c = first; c < last; c++)
+    {
+      out.Write(*fragments[c - first]);
+      fragments[c - first]->Clear();
+    }
+  }
+}
+
+//
+// Run 'count' tasks writing output: emit(sink, i) writes the output of
+// task i to 'sink'. Tasks are dealt round-robin to per-worker queues,
+// idle workers steal from the back of other queues. Each task writes to
+// its own memory sink; the calling thread appends finished fragments to
+// 'out' in task order, so the output is identical to a serial loop.
+//
+template <class F>
+inline void WriteTasks(OutputSink& out, size_t count, unsigned threads, F emit)
+{
+  if (threads <= 1 || count < 2)
+  {
+    for (size_t i = 0; i < count; i++)
+      emit(out, i);
+    return;
+  }
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  unsigned n = (unsigned)std::min((size_t)threads, count);
+  std::vector<Queue> queues(n);
+  for (size_t i = 0; i < count; i++)
+    queues[i % n].tasks.push_back(i);
+
+  std::vector<std::unique_ptr<OutputSink>> fragments(count);
+  std::vector<char> done(count, 0);
+  std::mutex mutex;
+  std::condition_variable finished;
+
+  // Own queue first, then steal
+  auto next = [&](unsigned w, size_t& task)
+  {
+    for (unsigned k = 0; k < n; k++)
+    {
+      Queue& q = queues[(w + k) % n];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      if (q.tasks.empty())
+        continue;
+      if (k == 0)
+      {
+        task = q.tasks.front();
+        q.tasks.pop_front();
+      }
+      else
+      {
+        task = q.tasks.back();
+        q.tasks.pop_back();
+      }
+      return true;
+    }
+    return false;
+  };
+
+  auto worker = [&](unsigned w)
+  {
+    for (size_t task; next(w, task);)
+    {
+      std::unique_ptr<OutputSink> frag(new OutputSink(0));
+      emit(*frag, task);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      fragments[task] = std::move(frag);
+      done[task] = 1;
+      finished.notify_all();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned w = 0; w < n; w++)
+    pool.emplace_back(worker, w);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    std::unique_ptr<OutputSink> frag;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [&] { return done[i] != 0; });
+      frag = std::move(fragments[i]);
+    }
+    out.Write(*frag);
+  }
+
+  for (auto& t : pool)
+    t.join();
+}
+
+#endif // POV_OUTPUT_H__
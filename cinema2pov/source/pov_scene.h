@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------
+// Scene IR - intermediate representation of the exported scene
+//
+// Export runs in two phases. The Execute() functions called by the SDK
+// only collect exportable objects into a tree of scene nodes: valid SDL
+// name, local matrix, material reference and a kind-specific payload.
+// The emitters then write SDL by walking this tree.
+//
+// Nodes, names and payloads live in an arena, freed at once with the
+// scene. Names are interned: objects with the same name share one copy.
+// Materials are registered once per SDK material and referenced by ID.
+//------------------------------------------------------------------------
+#ifndef POV_SCENE_H__
+#define POV_SCENE_H__
+
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <new>
+#include "pov_bounds.h"
+
+//
+// Bump allocator
+//
+class Arena
+{
+public:
+  static const size_t BLOCK_SIZE = 64 << 10;
+
+  void* Alloc(size_t size, size_t align = alignof(std::max_align_t))
+  {
+    size_t offset = (used + align - 1) & ~(align - 1);
+    if (blocks.empty() || offset + size > capacity)
+    {
+      capacity = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+      blocks.emplace_back(new char[capacity]);
+      offset = 0;
+    }
+    used = offset + size;
+    return blocks.back().get() + offset;
+  }
+
+  template <class T>
+  T* New()
+  {
+    return new (Alloc(sizeof(T), alignof(T))) T();
+  }
+
+  template <class T>
+  T* NewArray(size_t count)
+  {
+    T* p = (T*)Alloc(sizeof(T) * (count ? count : 1), alignof(T));
+    for (size_t i = 0; i < count; i++)
+      new (p + i) T();
+    return p;
+  }
+
+  const char* Copy(const char* str)
+  {
+    size_t len = strlen(str) + 1;
+    char* p = (char*)Alloc(len, 1);
+    memcpy(p, str, len);
+    return p;
+  }
+
+  void Clear()
+  {
+    blocks.clear();
+    used = capacity = 0;
+  }
+
+private:
+  std::vector<std::unique_ptr<char[]>> blocks;
+  size_t used = 0;
+  size_t capacity = 0;
+};
+
+enum SceneNodeKind
+{
+  NODE_NULL,
+  NODE_BOOL,
+  NODE_MESH,
+  NODE_PRIMITIVE,
+  NODE_SPLINE,
+  NODE_EXTRUDE,
+  NODE_SWEEP,
+  NODE_LATHE,
+  NODE_CAMERA,
+  NODE_LIGHT,
+};
+
+struct SceneNode;
+
+//
+// Writes SDL of a node, implemented by the exporting Alien classes
+//
+class SceneEmitter
+{
+public:
+  virtual ~SceneEmitter() {}
+  virtual void Emit(SceneNode* node) = 0;
+
+  // Called instead of Emit() when the SDL of the node is taken from the
+  // export cache, releases what Emit() would have released
+  virtual void Skip(SceneNode*) {}
+
+  // Animation: current values of the parameters Emit() writes through
+  // WriteParam(), returns their number (at most MAX_ANIM_PARAMS)
+  virtual int Animate(SceneNode*, double*) { return 0; }
+
+  // Object space box of what Emit() writes, false if unknown or
+  // infinite. Children are bounded before their parent.
+  virtual bool Bound(const SceneNode*, Bounds&) { return false; }
+};
+
+const int MAX_ANIM_PARAMS = 4;
+
+struct SceneNode
+{
+  SceneNodeKind kind;
+  const char* name = nullptr;      // valid SDL identifier
+  int material = -1;               // material ID, -1 if none
+  double matrix[12];               // local matrix: v1, v2, v3, off
+  bool declared = false;           // root object: #declare <name>, placed at the end
+  uint64_t hash = 0;               // hash of everything Emit() writes for the node
+
+  // Animated objects refer to per-frame arrays <animName>_M and _P
+  const char* animName = nullptr;  // nullptr if static
+  bool animMatrix = false;         // matrix varies
+  unsigned animParams = 0;         // bit k: parameter k varies
+
+  bool bounded = false;            // 'bounds' known, empty if nothing to bound
+  Bounds bounds;                   // object space, before the node matrix
+
+  const void* source = nullptr;    // SDK object
+  SceneEmitter* emitter = nullptr;
+  void* payload = nullptr;         // kind specific, arena allocated
+
+  SceneNode* parent = nullptr;
+  SceneNode* child = nullptr;
+  SceneNode* lastChild = nullptr;
+  SceneNode* next = nullptr;
+};
+
+class Scene
+{
+public:
+  Arena arena;
+
+  // Top level nodes in document order
+  SceneNode* first = nullptr;
+  SceneNode* last = nullptr;
+
+  //
+  // Add node for 'source' below the node of 'parentSource', or at top
+  // level when the parent isn't part of the scene
+  //
+  SceneNode* Add(SceneNodeKind kind, const void* source, const void* parentSource, SceneEmitter* emitter)
+  {
+    SceneNode* node = arena.New<SceneNode>();
+    node->kind = kind;
+    node->source = source;
+    node->emitter = emitter;
+
+    SceneNode* parent = Find(parentSource);
+    node->parent = parent;
+    SceneNode*& head = parent ? parent->child : first;
+    SceneNode*& tail = parent ? parent->lastChild : last;
+    if (tail)
+      tail->next = node;
+    else
+      head = node;
+    tail = node;
+
+    nodes[source] = node;
+    count++;
+    return node;
+  }
+
+  //
+  // Move 'node' with its subtree below 'parent', nullptr for top level,
+  // after sibling 'after' or last if nullptr
+  //
+  void Move(SceneNode* node, SceneNode* parent, SceneNode* after = nullptr)
+  {
+    Unlink(node);
+    node->parent = parent;
+    SceneNode*& head = parent ? parent->child : first;
+    SceneNode*& tail = parent ? parent->lastChild : last;
+    if (!after)
+      after = tail;
+    if (after)
+    {
+      node->next = after->next;
+      after->next = node;
+    }
+    else
+    {
+      node->next = head;
+      head = node;
+    }
+    if (tail == after)
+      tail = node;
+  }
+
+  SceneNode* Find(const void* source) const
+  {
+    if (!source)
+      return nullptr;
+    auto it = nodes.find(source);
+    return it == nodes.end() ? nullptr : it->second;
+  }
+
+  size_t Count() const { return count; }
+
+  //
+  // Interned copy of 'str', valid until Clear()
+  //
+  const char* Intern(std::string_view str)
+  {
+    auto it = strings.find(str);
+    if (it != strings.end())
+      return it->second;
+
+    char* copy = (char*)arena.Alloc(str.size() + 1, 1);
+    memcpy(copy, str.data(), str.size());
+    copy[str.size()] = '\0';
+    strings.emplace(std::string_view(copy, str.size()), copy);
+    return copy;
+  }
+
+  //
+  // Material registry: ID of SDK material 'source', nullptr if not yet
+  // registered by AddMaterial()
+  //
+  const int* FindMaterial(const void* source) const
+  {
+    auto it = materialIds.find(source);
+    return it == materialIds.end() ? nullptr : &it->second;
+  }
+
+  int AddMaterial(const void* source, const char* name)
+  {
+    int id = (int)materials.size();
+    materials.push_back(Intern(name));
+    materialIds[source] = id;
+    return id;
+  }
+
+  // SDL name of material 'id', nullptr for -1
+  const char* MaterialName(int id) const
+  {
+    return id >= 0 ? materials[id] : nullptr;
+  }
+
+  void Clear()
+  {
+    nodes.clear();
+    strings.clear();
+    materials.clear();
+    materialIds.clear();
+    first = last = nullptr;
+    count = 0;
+    arena.Clear();
+  }
+
+private:
+  // Remove 'node' from the siblings it is linked into, if any
+  void Unlink(SceneNode* node)
+  {
+    SceneNode*& head = node->parent ? node->parent->child : first;
+    SceneNode*& tail = node->parent ? node->parent->lastChild : last;
+    SceneNode* prev = nullptr;
+    SceneNode* n = head;
+    while (n && n != node)
+    {
+      prev = n;
+      n = n->next;
+    }
+    if (!n)
+      return;
+
+    (prev ? prev->next : head) = node->next;
+    if (tail == node)
+      tail = prev;
+    node->next = nullptr;
+  }
+
+  std::unordered_map<const void*, SceneNode*> nodes;
+  std::unordered_map<std::string_view, const char*> strings;  // views of the interned copies
+  std::vector<const char*> materials;                         // ID -> name
+  std::unordered_map<const void*, int> materialIds;
+  size_t count = 0;
+};
+
+#endif // POV_SCENE_H__
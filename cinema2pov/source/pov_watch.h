@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------
+// Directory watcher for the resident export mode
+//
+// Reports files of a directory matching a wildcard pattern once they were
+// written and then stayed untouched for the debounce time. Saving in place
+// writes a file in many steps (and C4D may also rename a temporary file
+// over it); every write or rename restarts the file's quiet period, so a
+// save is reported once, after it is complete.
+//
+// On Linux changes come from inotify, elsewhere the directory is polled
+// for changed modification times and sizes. When the inotify queue
+// overflows, events are lost: all matching files are rescanned and the
+// caller exports those with outputs older than the file.
+//------------------------------------------------------------------------
+#ifndef POV_WATCH_H__
+#define POV_WATCH_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include "pov_batch.h"
+
+#if defined(__linux__)
+#define POV_WATCH_INOTIFY
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+class DirWatcher
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  ~DirWatcher()
+  {
+#ifdef POV_WATCH_INOTIFY
+    if (fd >= 0)
+      close(fd);
+#endif
+  }
+
+  bool Open(const char* directory, const char* filePattern, int debounceMs)
+  {
+    dir = directory;
+    pattern = filePattern;
+    debounce = std::chrono::milliseconds(debounceMs);
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec))
+      return false;
+
+#ifdef POV_WATCH_INOTIFY
+    fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+      return false;
+    return inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO) >= 0;
+#else
+    Scan(false);
+    return true;
+#endif
+  }
+
+  // Matching files of the directory, sorted
+  std::vector<std::string> Files() const
+  {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+      std::string name = it->path().filename().string();
+      if (it->is_regular_file(ec) && WildcardMatch(pattern.c_str(), name.c_str()))
+        files.push_back(it->path().string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  //
+  // Block until some files were written and are quiet, returns their paths.
+  // 'rescan' is set if events were lost and the paths include rescanned
+  // files: only those newer than their output were written.
+  //
+  std::vector<std::string> Wait(bool& rescan)
+  {
+    rescan = false;
+    std::vector<std::string> ready;
+    while (ready.empty())
+    {
+      // Sleep until the earliest quiet period ends, or for new events
+      int timeout = -1;
+      Clock::time_point now = Clock::now();
+      for (auto& p : pending)
+      {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(p.second - now).count();
+        left = left < 0 ? 0 : left + 1;
+        if (timeout < 0 || left < timeout)
+          timeout = (int)left;
+      }
+      Poll(timeout);
+
+      now = Clock::now();
+      for (auto it = pending.begin(); it != pending.end();)
+        if (it->second <= now)
+        {
+          ready.push_back((std::filesystem::path(dir) / it->first).string());
+          rescan |= lost.erase(it->first) > 0;
+          it = pending.erase(it);
+        }
+        else
+          ++it;
+    }
+    std::sort(ready.begin(), ready.end());
+    return ready;
+  }
+
+private:
+  void Touch(const std::string& name)
+  {
+    if (WildcardMatch(pattern.c_str(), name.c_str()))
+      pending[name] = Clock::now() + debounce;
+  }
+
+#ifdef POV_WATCH_INOTIFY
+  void Poll(int timeout)
+  {
+    pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout) <= 0)
+      return;
+
+    alignas(inotify_event) char buf[16 * 1024];
+    ssize_t len = read(fd, buf, sizeof(buf));
+    bool overflow = false;
+    for (ssize_t off = 0; off < len;)
+    {
+      const inotify_event* ev = (const inotify_event*)(buf + off);
+      if (ev->mask & IN_Q_OVERFLOW)
+        overflow = true;
+      else if (ev->len > 0 && !(ev->mask & IN_ISDIR))
+        Touch(ev->name);
+      off += sizeof(inotify_event) + ev->len;
+    }
+
+    // Events lost: every matching file may have been written
+    if (overflow)
+      for (const std::string& path : Files())
+      {
+        std::string name = std::filesystem::path(path).filename().string();
+        Touch(name);
+        lost.insert(name);
+      }
+  }
+
+  int fd = -1;
+#else
+  struct FileState
+  {
+    std::filesystem::file_time_type time;
+    uintmax_t size;
+  };
+
+  void Poll(int timeout)
+  {
+    std::chrono::milliseconds interval = std::max(debounce / 4, std::chrono::milliseconds(50));
+    if (timeout >= 0)
+      interval = std::min(interval, std::chrono::milliseconds(timeout));
+    std::this_thread::sleep_for(interval);
+    Scan(true);
+  }
+
+  // Compare modification times and sizes with the last scan
+  void Scan(bool report)
+  {
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+      std::string name = it->path().filename().string();
+      FileState st = { it->last_write_time(ec), it->file_size(ec) };
+      if (ec)
+        continue;
+
+      auto known = files.find(name);
+      bool changed = known == files.end() || known->second.time != st.time || known->second.size != st.size;
+      files[name] = st;
+      if (changed && report)
+        Touch(name);
+    }
+  }
+
+  std::unordered_map<std::string, FileState> files;
+#endif
+
+  std::string dir;
+  std::string pattern;
+  std::chrono::milliseconds debounce{ 500 };
+  std::unordered_map<std::string, Clock::time_point> pending;  // file name -> end of quiet period
+  std::unordered_set<std::string> lost;                        // pending after lost events
+};
+
+#endif // POV_WATCH_H__
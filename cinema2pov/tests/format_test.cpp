@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------
+// Tests of the SDL number formatting (pov_format.h)
+//
+// Header only, no SDK needed:
+//   g++ -std=c++17 -I../source format_test.cpp -o format_test && ./format_test
+//   cl /std:c++17 /EHsc /I..\source format_test.cpp && format_test
+//------------------------------------------------------------------------
+#include <cstdio>
+#include <string>
+#include "pov_format.h"
+
+static int failed = 0;
+
+static void Expect(bool ok, const char* what)
+{
+  if (!ok)
+  {
+    printf("FAILED: %s\n", what);
+    failed++;
+  }
+}
+
+static std::string Format(double v, const NumberFormat& f)
+{
+  char buf[MAX_NUMBER_CHARS + 1];
+  *FormatFloat(buf, v, f) = 0;
+  return buf;
+}
+
+int main()
+{
+  // Decimals of quantization steps
+  Expect(QuantumDigits(1.0) == 0, "QuantumDigits(1)");
+  Expect(QuantumDigits(5.0) == 0, "QuantumDigits(5)");
+  Expect(QuantumDigits(0.1) == 1, "QuantumDigits(0.1)");
+  Expect(QuantumDigits(0.25) == 2, "QuantumDigits(0.25)");
+  Expect(QuantumDigits(0.0625) == 4, "QuantumDigits(0.0625)");
+  Expect(QuantumDigits(0.001) == 3, "QuantumDigits(0.001)");
+  Expect(QuantumDigits(1e-9) == 9, "QuantumDigits(1e-9)");
+  Expect(QuantumDigits(1e-10) == 10, "QuantumDigits(1e-10)");
+  Expect(QuantumDigits(2.5e-12) == 13, "QuantumDigits(2.5e-12)");
+
+  // Quantized values
+  NumberFormat quarter(FLOAT_QUANTIZED, 0, 0.25);
+  Expect(Format(1.3, quarter) == "1.25", "0.25 grid");
+  NumberFormat tiny(FLOAT_QUANTIZED, 0, 1e-10);
+  Expect(Format(1.23456789012345, tiny) == "1.2345678901", "1e-10 grid");
+  Expect(Format(3e-10, tiny) == "0.0000000003", "1e-10 grid, small value");
+
+  // Fixed decimals, trailing zeros trimmed
+  NumberFormat fixed(FLOAT_FIXED, 4);
+  Expect(Format(2.5, fixed) == "2.5", "fixed 2.5");
+  Expect(Format(1.0 / 3.0, fixed) == "0.3333", "fixed 1/3");
+
+  if (failed)
+    return 1;
+  printf("format_test: ok\n");
+  return 0;
+}